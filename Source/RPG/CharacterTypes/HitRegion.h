@@ -0,0 +1,12 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class EHitRegion : uint8
+{
+	EHR_Head UMETA(DisplayName = "Head"),
+	EHR_Torso UMETA(DisplayName = "Torso"),
+	EHR_Arm UMETA(DisplayName = "Arm"),
+	EHR_Leg UMETA(DisplayName = "Leg"),
+
+	EHR_MAX UMETA(DisplayName = "DefaultMAX")
+};
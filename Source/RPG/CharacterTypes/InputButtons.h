@@ -0,0 +1,11 @@
+#pragma once
+
+// Held buttons, one bit each. Only changes are acted on
+UENUM(meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EInputButton : uint8
+{
+	EIB_None = 0 UMETA(Hidden),
+	EIB_Aim = 1 << 0 UMETA(DisplayName = "Aim"),
+	EIB_Fire = 1 << 1 UMETA(DisplayName = "Fire")
+};
+ENUM_CLASS_FLAGS(EInputButton);
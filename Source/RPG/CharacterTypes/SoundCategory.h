@@ -0,0 +1,11 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class ESoundCategory : uint8
+{
+	ESC_Shell UMETA(DisplayName = "Shell"),
+	ESC_Impact UMETA(DisplayName = "Impact"),
+	ESC_Weapon UMETA(DisplayName = "Weapon"),
+
+	ESC_MAX UMETA(DisplayName = "DefaultMax")
+};
@@ -47,19 +47,18 @@ void UCharacterAnimInstance::NativeUpdateAnimation(float DeltaTime)
 	AO_Yaw = MainCharacter->GetAO_Yaw();
 	AO_Pitch = MainCharacter->GetAO_Pitch();
 
-	if (bWeaponEquipped && EquippedWeapon && EquippedWeapon->GetWeaponMesh() && MainCharacter->GetMesh())
+	FTransform RightHandTransform;
+	if (bWeaponEquipped && EquippedWeapon && MainCharacter->GetRightHandBoneTransform(RightHandTransform) &&
+		EquippedWeapon->GetLeftHandSocketTransform(LeftHandTransform))
 	{
-		LeftHandTransform = EquippedWeapon->GetWeaponMesh()->GetSocketTransform(FName("LeftHandSocket"), RTS_World);
-		FVector OutPosition;
-		FRotator OutRotation;
-		MainCharacter->GetMesh()->TransformToBoneSpace(FName("hand_r"), LeftHandTransform.GetLocation(), FRotator::ZeroRotator, OutPosition, OutRotation);
-		LeftHandTransform.SetLocation(OutPosition);
-		LeftHandTransform.SetRotation(FQuat(OutRotation));
+		// Left hand socket in hand_r bone space
+		const FTransform LeftHandInBoneSpace = FTransform(FRotator::ZeroRotator, LeftHandTransform.GetLocation()).GetRelativeTransform(RightHandTransform);
+		LeftHandTransform.SetLocation(LeftHandInBoneSpace.GetLocation());
+		LeftHandTransform.SetRotation(LeftHandInBoneSpace.GetRotation());
 
 		if (MainCharacter->IsLocallyControlled())
 		{
 			bLocallyControlled = true;
-			FTransform RightHandTransform = MainCharacter->GetMesh()->GetSocketTransform(FName("hand_r"), RTS_World);
 			FRotator LookAtRotation = UKismetMathLibrary::FindLookAtRotation(RightHandTransform.GetLocation(), RightHandTransform.GetLocation() + (RightHandTransform.GetLocation() - MainCharacter->GetHitTarget()));
 			RightHandRotation = FMath::RInterpTo(RightHandRotation, LookAtRotation, DeltaTime, 80000.f);
 		}
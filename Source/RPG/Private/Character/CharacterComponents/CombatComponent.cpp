@@ -3,24 +3,34 @@
 
 #include "Character/CharacterComponents/CombatComponent.h"
 #include "Character/MainCharacter.h"
+#include "Character/CharacterComponents/MainCharacterMovementComponent.h"
+#include "Character/Weapon/HitScanWeapon.h"
 #include "Character/Weapon/Weapon.h"
+#include "Character/Weapon/WeaponDefinition.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/GameStateBase.h"
 #include "Kismet/GameplayStatics.h"
 #include "Net/UnrealNetwork.h"
 #include "DrawDebugHelpers.h"
 #include "Camera/CameraComponent.h"
-#include "TimerManager.h"
 #include "Character/PlayerController/CharacterPlayerController.h"
+#include "Character/Subsystems/AudioDispatchSubsystem.h"
+#include "RPG/RPG.h"
 #include "Sound/SoundCue.h"
 
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon Swaps"), STAT_WeaponSwaps, STATGROUP_RPG);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Weapon Swap Latency (ms)"), STAT_WeaponSwapLatency, STATGROUP_RPG);
+
 
 UCombatComponent::UCombatComponent()
 {
-	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bCanEverTick = false;
 
 	fBaseWalkSpeed = 600.f;
 	fAimWalkSpeed = 400.f;
+
+	ShotLog.OwnerComponent = this;
 }
 
 void UCombatComponent::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
@@ -31,6 +41,9 @@ void UCombatComponent::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty
 	DOREPLIFETIME(UCombatComponent, bAiming);
 	DOREPLIFETIME_CONDITION(UCombatComponent, CarriedAmmo, COND_OwnerOnly);
 	DOREPLIFETIME(UCombatComponent, CombatState)
+	DOREPLIFETIME_CONDITION(UCombatComponent, ShotLog, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(UCombatComponent, Loadout, COND_OwnerOnly);
+	DOREPLIFETIME_CONDITION(UCombatComponent, ActiveSlot, COND_OwnerOnly);
 }
 
 void UCombatComponent::BeginPlay()
@@ -39,7 +52,8 @@ void UCombatComponent::BeginPlay()
 
 	if (Character)
 	{
-		Character->GetCharacterMovement()->MaxWalkSpeed = fBaseWalkSpeed;
+		Character->GetMainCharacterMovement()->MaxWalkSpeed = fBaseWalkSpeed;
+		Character->GetMainCharacterMovement()->MaxWalkSpeedAiming = fAimWalkSpeed;
 
 		if (Character->GetFollowCamera())
 		{
@@ -49,44 +63,46 @@ void UCombatComponent::BeginPlay()
 		if (Character->HasAuthority())
 		{
 			InitializeCarriedAmmo();
+			SpawnDefaultLoadout();
 		}
 	}
 }
 
-void UCombatComponent::TickComponent(float DeltaTime, ELevelTick TickType,
-                                     FActorComponentTickFunction* ThisTickFunction)
+void UCombatComponent::BatchedTick(float DeltaTime)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
 	if (Character && Character->IsLocallyControlled())
 	{
 		FHitResult HitResult;
 		TraceUnderCrosshair(HitResult);
 		HitTarget = HitResult.ImpactPoint;
 
+#if !UE_SERVER
 		SetHUDCrosshairs(DeltaTime);
 		InterpFOV(DeltaTime);
+#endif
+		UpdateFireScheduler(DeltaTime);
 	}
 }
 
 
 void UCombatComponent::SetHUDCrosshairs(float DeltaTime)
 {
-	if (Character == nullptr || Character->Controller == nullptr) return;
+	// Controller and HUD are bound by the controller once the player is set up
+	if (Character == nullptr) return;
 
-	Controller = Controller == nullptr ? Cast<ACharacterPlayerController>(Character->Controller) : Controller;
 	if (Controller)
 	{
-		HUD = HUD == nullptr ? Cast<ACharacterHUD>(Controller->GetHUD()) : HUD;
 		if (HUD)
 		{
-			if (EquippedWeapon)
+			const UWeaponDefinition* Definition = EquippedWeapon ? EquippedWeapon->GetDefinition() : nullptr;
+			if (Definition)
 			{
-				HUDPackage.CrosshairsCenter = EquippedWeapon->CrosshairsCenter;
-				HUDPackage.CrosshairsLeft = EquippedWeapon->CrosshairsLeft;
-				HUDPackage.CrosshairsRight = EquippedWeapon->CrosshairsRight;
-				HUDPackage.CrosshairsTop = EquippedWeapon->CrosshairsTop;
-				HUDPackage.CrosshairsBottom = EquippedWeapon->CrosshairsBottom;
+				// Stay empty until the crosshair textures have streamed in
+				HUDPackage.CrosshairsCenter = Definition->CrosshairsCenter.Get();
+				HUDPackage.CrosshairsLeft = Definition->CrosshairsLeft.Get();
+				HUDPackage.CrosshairsRight = Definition->CrosshairsRight.Get();
+				HUDPackage.CrosshairsTop = Definition->CrosshairsTop.Get();
+				HUDPackage.CrosshairsBottom = Definition->CrosshairsBottom.Get();
 			}
 			else
 			{
@@ -97,7 +113,7 @@ void UCombatComponent::SetHUDCrosshairs(float DeltaTime)
 				HUDPackage.CrosshairsBottom = nullptr;
 			}
 
-			FVector2D WalkSpeedRange(0.f, Character->GetCharacterMovement()->MaxWalkSpeed);
+			FVector2D WalkSpeedRange(0.f, Character->GetCharacterMovement()->GetMaxSpeed());
 			FVector2D VelocityMultiplierRange(0.f, 1.f);
 			FVector Velocity = Character->GetVelocity();
 			Velocity.Z = 0.f;
@@ -157,23 +173,12 @@ void UCombatComponent::InterpFOV(float DeltaTime)
 }
 
 void UCombatComponent::SetAiming(bool bIsAiming)
-{
-	bAiming = bIsAiming;
-	ServerSetAiming(bIsAiming);
-
-	if (Character)
-	{
-		Character->GetCharacterMovement()->MaxWalkSpeed = bIsAiming ? fAimWalkSpeed : fBaseWalkSpeed;
-	}
-}
-
-void UCombatComponent::ServerSetAiming_Implementation(bool bIsAiming)
 {
 	bAiming = bIsAiming;
 
 	if (Character)
 	{
-		Character->GetCharacterMovement()->MaxWalkSpeed = bIsAiming ? fAimWalkSpeed : fBaseWalkSpeed;
+		Character->GetMainCharacterMovement()->SetWantsToAim(bIsAiming);
 	}
 }
 
@@ -191,45 +196,83 @@ void UCombatComponent::Fire()
 {
 	if (CanFire())
 	{
-		bCanFire = false;
-		ServerFire(HitTarget);
-		if (EquippedWeapon)
-		{
-			CrosshairShootingFactor = 0.75f;
-		}
-		StartFireTimer();
+		QueueShot(GetFireClock());
+		FlushShots();
 	}
 }
 
-void UCombatComponent::StartFireTimer()
+void UCombatComponent::UpdateFireScheduler(float DeltaTime)
 {
-	if (EquippedWeapon == nullptr || Character == nullptr) return;
-	Character->GetWorldTimerManager().SetTimer(
-		FireTimer,
-		this,
-		&UCombatComponent::FireTimerFinished,
-		EquippedWeapon->FireDelay
-	);
-}
+	if (!bFireCooldownActive) return;
 
-void UCombatComponent::FireTimerFinished()
-{
-	if (EquippedWeapon == nullptr) return;
-	bCanFire = true;
-	if (bFireButtonPressed && EquippedWeapon->bAutomatic)
+	FireCooldown -= DeltaTime;
+	const float FrameTime = GetFireClock();
+	int32 NumShots = 0;
+	while (bFireButtonPressed && EquippedWeapon && EquippedWeapon->bAutomatic && CanFire() && NumShots < MaxShotsPerFrame)
 	{
-		Fire();
+		// A negative cooldown is how far back in this frame the shot was due
+		QueueShot(FrameTime + FireCooldown);
+		NumShots++;
 	}
-	if (EquippedWeapon->IsEmpty())
+	FlushShots();
+
+	if (FireCooldown <= 0.f)
 	{
-		Reload();
+		// Stopped firing, don't bank time towards the next trigger pull
+		FireCooldown = 0.f;
+		bFireCooldownActive = false;
+		if (EquippedWeapon && EquippedWeapon->IsEmpty())
+		{
+			Reload();
+		}
 	}
 }
 
+void UCombatComponent::QueueShot(float FireTime)
+{
+	FShotRequest Shot;
+	Shot.HitTarget = HitTarget;
+	Shot.MuzzleLocation = EquippedWeapon->GetMuzzleLocation();
+	Shot.FireTime = FireTime;
+	Shot.SpreadSeed = static_cast<uint16>(FMath::Rand());
+	Shot.Slot = static_cast<uint8>(ActiveSlot);
+
+	FireCooldown += EquippedWeapon->FireDelay;
+	bFireCooldownActive = true;
+	CrosshairShootingFactor = 0.75f;
+
+	// The server fires right away, remote owners predict the shot and send it with the batch
+	if (Character->HasAuthority())
+	{
+		ServerFire(Shot);
+		return;
+	}
+	Shot.Sequence = EquippedWeapon->PredictShot();
+	LocalFire(HitTarget, bAiming, Shot.SpreadSeed);
+	PendingShots.Add(Shot);
+}
+
+void UCombatComponent::FlushShots()
+{
+	if (PendingShots.Num() == 0) return;
+
+	ServerFireBatch(PendingShots);
+	PendingShots.Reset();
+}
+
+float UCombatComponent::GetFireClock()
+{
+	if (Controller == nullptr || Character == nullptr || Character->HasAuthority()) return GetWorld()->GetTimeSeconds();
+
+	// Server time of what the shooter is looking at: the state on screen left the server one trip
+	// ago and remote characters are played back a further ProxyInterpDelay behind that
+	return Controller->GetServerTime() - Controller->GetSingleTripTime() - Character->GetProxyInterpDelay();
+}
+
 bool UCombatComponent::CanFire()
 {
-	if (EquippedWeapon == nullptr) return false;
-	return !EquippedWeapon->IsEmpty() && bCanFire && CombatState == ECombatState::ECS_Unoccupied;
+	if (EquippedWeapon == nullptr || IsSwapPending()) return false;
+	return !EquippedWeapon->IsEmpty() && FireCooldown <= 0.f && CombatState == ECombatState::ECS_Unoccupied;
 }
 
 void UCombatComponent::TraceUnderCrosshair(FHitResult& TraceHitResult)
@@ -265,7 +308,7 @@ void UCombatComponent::TraceUnderCrosshair(FHitResult& TraceHitResult)
 			TraceHitResult,
 			Start,
 			End,
-			ECC_Visibility
+			ECC_WeaponTrace
 		);
 		if (TraceHitResult.ImpactPoint.IsZero())
 		{
@@ -282,19 +325,100 @@ void UCombatComponent::TraceUnderCrosshair(FHitResult& TraceHitResult)
 	}
 }
 
-void UCombatComponent::ServerFire_Implementation(const FVector_NetQuantize& TraceHitTarget)
+void UCombatComponent::ServerFireBatch_Implementation(const TArray<FShotRequest>& Shots)
+{
+	if (Character)
+	{
+		Character->CountServerRPC();
+	}
+	const int32 NumShots = FMath::Min(Shots.Num(), MaxShotsPerFrame);
+	for (int32 i = 0; i < NumShots; ++i)
+	{
+		ServerFire(Shots[i]);
+	}
+}
+
+void UCombatComponent::ServerFire(const FShotRequest& Shot)
+{
+	if (EquippedWeapon == nullptr || Character == nullptr) return;
+
+	// Fired with a weapon that has since been swapped out. Its sequence belongs to that weapon,
+	// so the rejection is acknowledged there and the weapon in hand is left alone
+	if (Shot.Slot != ActiveSlot)
+	{
+		AWeapon* ShotWeapon = Loadout.IsValidIndex(Shot.Slot) ? Loadout[Shot.Slot] : nullptr;
+		if (ShotWeapon)
+		{
+			ShotWeapon->AcknowledgeShot(Shot.Sequence);
+		}
+		return;
+	}
+
+	// The claimed time can't be in the future, too far in the past, or before the last accepted shot
+	const float ServerTime = GetWorld()->GetTimeSeconds();
+	float FireTime = FMath::Clamp(Shot.FireTime, ServerTime - MaxFireRewindTime, ServerTime);
+	if (LastServerFireTime >= 0.f)
+	{
+		FireTime = FMath::Max(FireTime, LastServerFireTime);
+	}
+
+	if (ValidateServerFire(FireTime) && ConsumeShotBudget(ServerTime))
+	{
+		LastServerFireTime = FireTime;
+
+		AHitScanWeapon* HitScanWeapon = Cast<AHitScanWeapon>(EquippedWeapon);
+		if (HitScanWeapon)
+		{
+			HitScanWeapon->SubmitRewindShot(Shot.MuzzleLocation, Shot.HitTarget, FireTime, Shot.SpreadSeed);
+		}
+		LocalFire(Shot.HitTarget, bAiming, Shot.SpreadSeed);
+		ShotLog.AddShot(Shot.HitTarget, GetWorld()->GetTimeSeconds(), bAiming, Shot.SpreadSeed);
+	}
+
+	// Rejected shots are acknowledged too, so the owner drops its prediction for them
+	EquippedWeapon->AcknowledgeShot(Shot.Sequence);
+}
+
+bool UCombatComponent::ValidateServerFire(float FireTime) const
 {
-	MulticastFire(TraceHitTarget);
+	if (EquippedWeapon->IsEmpty() || CombatState != ECombatState::ECS_Unoccupied) return false;
+	return LastServerFireTime < 0.f || FireTime - LastServerFireTime >= EquippedWeapon->FireDelay * FireCadenceTolerance;
 }
 
-void UCombatComponent::MulticastFire_Implementation(const FVector_NetQuantize& TraceHitTarget)
+bool UCombatComponent::ConsumeShotBudget(float ServerTime)
 {
-	if (EquippedWeapon == nullptr) return;
-	if (Character && CombatState == ECombatState::ECS_Unoccupied)
+	// Refills at exactly the weapon's rate, the tolerance only applies to the spacing of single shots
+	const float ShotInterval = FMath::Max(EquippedWeapon->FireDelay, KINDA_SMALL_NUMBER);
+	if (LastShotBudgetTime < 0.f)
+	{
+		ShotBudget = MaxShotBudget;
+	}
+	else
 	{
-		Character->PlayFireMontage(bAiming);
-		EquippedWeapon->Fire(TraceHitTarget);
+		ShotBudget = FMath::Min(ShotBudget + (ServerTime - LastShotBudgetTime) / ShotInterval, MaxShotBudget);
 	}
+	LastShotBudgetTime = ServerTime;
+
+	if (ShotBudget < 1.f) return false;
+	ShotBudget -= 1.f;
+	return true;
+}
+
+void UCombatComponent::LocalFire(const FVector& TraceHitTarget, bool bShotAiming, uint16 SpreadSeed)
+{
+	if (EquippedWeapon == nullptr || Character == nullptr) return;
+
+	Character->PlayFireMontage(bShotAiming);
+	EquippedWeapon->Fire(TraceHitTarget, SpreadSeed);
+}
+
+void UCombatComponent::PlayShotRecord(const FShotRecord& Record)
+{
+	// Already validated by the server, only skip what is too old to be worth showing (e.g. on join)
+	AGameStateBase* GameState = GetWorld() ? GetWorld()->GetGameState() : nullptr;
+	if (GameState && GameState->GetServerWorldTimeSeconds() - Record.ServerTime > MaxShotPlaybackAge) return;
+
+	LocalFire(Record.HitTarget, Record.bAiming, Record.SpreadSeed);
 }
 
 
@@ -302,39 +426,116 @@ void UCombatComponent::EquipWeapon(AWeapon* WeaponToEquip)
 {
 	if (Character == nullptr || WeaponToEquip == nullptr) return;
 
-	if (EquippedWeapon)
+	// A picked up weapon takes a free slot, or replaces the one in hand when the loadout is full
+	if (Loadout.Num() < MaxLoadoutSlots || !Loadout.IsValidIndex(ActiveSlot))
 	{
-		EquippedWeapon->Dropped();
+		HolsterWeapon(EquippedWeapon);
+		ActiveSlot = Loadout.Add(WeaponToEquip);
+	}
+	else
+	{
+		if (EquippedWeapon)
+		{
+			EquippedWeapon->Dropped();
+		}
+		Loadout[ActiveSlot] = WeaponToEquip;
 	}
 
-	EquippedWeapon = WeaponToEquip;
-	EquippedWeapon->SetWeaponState(EweaponState::EWS_Equipped);
-	const USkeletalMeshSocket* HandSocket = Character->GetMesh()->GetSocketByName(FName("RightHandSocket"));
-	if (HandSocket)
+	WeaponToEquip->SetOwner(Character);
+	ActivateWeapon(WeaponToEquip);
+}
+
+void UCombatComponent::SpawnDefaultLoadout()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || Character == nullptr) return;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = Character;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (const TSubclassOf<AWeapon>& WeaponClass : DefaultLoadout)
 	{
-		HandSocket->AttachActor(EquippedWeapon, Character->GetMesh());
+		if (WeaponClass == nullptr || Loadout.Num() >= MaxLoadoutSlots) continue;
+
+		AWeapon* Weapon = World->SpawnActor<AWeapon>(WeaponClass, Character->GetActorTransform(), SpawnParams);
+		if (Weapon == nullptr) continue;
+
+		Loadout.Add(Weapon);
+		HolsterWeapon(Weapon);
 	}
-	EquippedWeapon->SetOwner(Character);
-	EquippedWeapon->SetHudAmmo();
 
-	if (CarriedAmmoMap.Contains(EquippedWeapon->GetWeaponType()))
+	if (Loadout.Num() > 0)
 	{
-		CarriedAmmo = CarriedAmmoMap[EquippedWeapon->GetWeaponType()];
+		ActiveSlot = 0;
+		ActivateWeapon(Loadout[0]);
 	}
-	Controller = Controller == nullptr ? Cast<ACharacterPlayerController>(Character->Controller) : Controller;
-	if (Controller)
+}
+
+void UCombatComponent::SwapToNextWeapon()
+{
+	if (Character == nullptr || Loadout.Num() < 2 || CombatState != ECombatState::ECS_Unoccupied || IsSwapPending()) return;
+
+	// The server swaps right away, remote owners hold fire until the new weapon replicates
+	if (!Character->HasAuthority())
 	{
-		Controller->SetHudCarriedAmmo(CarriedAmmo);
+		SwapRequestTime = FPlatformTime::Seconds();
 	}
+	ServerSwapWeapon((ActiveSlot + 1) % Loadout.Num());
+}
+
+bool UCombatComponent::IsSwapPending() const
+{
+	return SwapRequestTime > 0.0 && FPlatformTime::Seconds() - SwapRequestTime < MaxSwapWaitTime;
+}
 
-	if (EquippedWeapon->EquipSound)
+void UCombatComponent::ServerSwapWeapon_Implementation(int32 Slot)
+{
+	if (Character)
 	{
-		UGameplayStatics::PlaySoundAtLocation(
-			this,
-			EquippedWeapon->EquipSound,
-			Character->GetActorLocation()
-		);
+		Character->CountServerRPC();
 	}
+	SwapToSlot(Slot);
+}
+
+void UCombatComponent::SwapToSlot(int32 Slot)
+{
+	if (!Loadout.IsValidIndex(Slot) || Slot == ActiveSlot || Loadout[Slot] == nullptr) return;
+	if (CombatState != ECombatState::ECS_Unoccupied) return;
+
+	// No spawn or destroy, just a state flip on each weapon and an attach
+	HolsterWeapon(EquippedWeapon);
+	ActiveSlot = Slot;
+	ActivateWeapon(Loadout[Slot]);
+	INC_DWORD_STAT(STAT_WeaponSwaps);
+}
+
+void UCombatComponent::HolsterWeapon(AWeapon* Weapon)
+{
+	if (Weapon == nullptr || Character == nullptr) return;
+
+	// Attach before going dormant so the attachment still replicates
+	Weapon->AttachToComponent(Character->GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+	Weapon->SetWeaponState(EweaponState::EWS_Holstered);
+}
+
+void UCombatComponent::ActivateWeapon(AWeapon* Weapon)
+{
+	EquippedWeapon = Weapon;
+	// Fire rate is per weapon, the new one starts its own cadence
+	FireCooldown = 0.f;
+	bFireCooldownActive = false;
+	LastServerFireTime = -1.f;
+	EquippedWeapon->SetWeaponState(EweaponState::EWS_Equipped);
+	const USkeletalMeshSocket* HandSocket = Character->GetRightHandSocket();
+	if (HandSocket)
+	{
+		HandSocket->AttachActor(EquippedWeapon, Character->GetMesh());
+	}
+	EquippedWeapon->SetHudAmmo();
+
+	UpdateHUDCarriedAmmo();
+
+	PlayEquipSound();
 
 	if (EquippedWeapon->IsEmpty())
 	{
@@ -345,9 +546,40 @@ void UCombatComponent::EquipWeapon(AWeapon* WeaponToEquip)
 	Character->bUseControllerRotationYaw = true;
 }
 
+void UCombatComponent::PlayEquipSound()
+{
+	UAudioDispatchSubsystem* AudioDispatch = GetWorld()->GetSubsystem<UAudioDispatchSubsystem>();
+	if (AudioDispatch && EquippedWeapon && Character)
+	{
+		AudioDispatch->PlaySound(EquippedWeapon->GetEquipSound(), Character->GetActorLocation(), ESoundCategory::ESC_Weapon);
+	}
+}
+
+void UCombatComponent::DiscardLoadout()
+{
+	if (EquippedWeapon)
+	{
+		EquippedWeapon->Dropped();
+	}
+	DestroyHolsteredWeapons();
+	Loadout.Reset();
+	ActiveSlot = INDEX_NONE;
+}
+
+void UCombatComponent::DestroyHolsteredWeapons()
+{
+	for (AWeapon* Weapon : Loadout)
+	{
+		if (Weapon && Weapon != EquippedWeapon)
+		{
+			Weapon->Destroy();
+		}
+	}
+}
+
 void UCombatComponent::Reload()
 {
-	if (CarriedAmmo > 0 && CombatState != ECombatState::ECS_Reloading)
+	if (GetCarriedAmmo() > 0 && CombatState != ECombatState::ECS_Reloading)
 	{
 		ServerReload();
 	}
@@ -355,6 +587,10 @@ void UCombatComponent::Reload()
 
 void UCombatComponent::ServerReload_Implementation()
 {
+	if (Character)
+	{
+		Character->CountServerRPC();
+	}
 	if (Character == nullptr || EquippedWeapon == nullptr) return;
 	CombatState = ECombatState::ECS_Reloading;
 	HandleReload();
@@ -369,14 +605,8 @@ int32 UCombatComponent::AmountToReload()
 {
 	if (EquippedWeapon == nullptr) return 0;
 	int32 RoomInMag = EquippedWeapon->GetMagCapacity() - EquippedWeapon->GetAmmo();
-
-	if (CarriedAmmoMap.Contains(EquippedWeapon->GetWeaponType()))
-	{
-		int32 AmmountCarried = CarriedAmmoMap[EquippedWeapon->GetWeaponType()];
-		int32 Least = FMath::Min(RoomInMag, AmmountCarried);
-		return FMath::Clamp(RoomInMag, 0, Least);
-	}
-	return 0;
+	int32 Least = FMath::Min(RoomInMag, GetCarriedAmmo());
+	return FMath::Clamp(RoomInMag, 0, Least);
 }
 
 
@@ -398,16 +628,8 @@ void UCombatComponent::UpdateAmmoValues()
 {
 	if (Character == nullptr || EquippedWeapon == nullptr) return;
 	int32 ReloadAmount = AmountToReload();
-	if (CarriedAmmoMap.Contains(EquippedWeapon->GetWeaponType()))
-	{
-		CarriedAmmoMap[EquippedWeapon->GetWeaponType()] -= ReloadAmount;
-		CarriedAmmo = CarriedAmmoMap[EquippedWeapon->GetWeaponType()];
-	}
-	Controller = Controller == nullptr ? Cast<ACharacterPlayerController>(Character->Controller) : Controller;
-	if (Controller)
-	{
-		Controller->SetHudCarriedAmmo(CarriedAmmo);
-	}
+	CarriedAmmo.Add(EquippedWeapon->GetWeaponType(), -ReloadAmount);
+	UpdateHUDCarriedAmmo();
 	EquippedWeapon->AddAmmo(-ReloadAmount);
 }
 
@@ -429,38 +651,55 @@ void UCombatComponent::OnRep_CombatState()
 
 void UCombatComponent::OnRep_EquipedWeapon()
 {
+	// Only a swap still being waited on is measured, one the server refused has long timed out
+	if (IsSwapPending())
+	{
+		const float SwapLatencyMs = static_cast<float>((FPlatformTime::Seconds() - SwapRequestTime) * 1000.0);
+		SET_FLOAT_STAT(STAT_WeaponSwapLatency, SwapLatencyMs);
+		UE_LOG(LogRPG, Verbose, TEXT("Weapon swap took %.1f ms"), SwapLatencyMs);
+	}
+	SwapRequestTime = 0.0;
+	FireCooldown = 0.f;
+	bFireCooldownActive = false;
+
 	if (EquippedWeapon && Character)
 	{
 		EquippedWeapon->SetWeaponState(EweaponState::EWS_Equipped);
-		const USkeletalMeshSocket* HandSocket = Character->GetMesh()->GetSocketByName(FName("RightHandSocket"));
+		const USkeletalMeshSocket* HandSocket = Character->GetRightHandSocket();
 		if (HandSocket)
 		{
 			HandSocket->AttachActor(EquippedWeapon, Character->GetMesh());
 		}
-		if (EquippedWeapon->EquipSound)
-		{
-			UGameplayStatics::PlaySoundAtLocation(
-				this,
-				EquippedWeapon->EquipSound,
-				Character->GetActorLocation()
-			);
-		}
+		PlayEquipSound();
 		Character->GetCharacterMovement()->bOrientRotationToMovement = false;
 		Character->bUseControllerRotationYaw = true;
+		UpdateHUDCarriedAmmo();
 	}
 }
 
 void UCombatComponent::OnRep_CarriedAmmo()
 {
-	Controller = Controller == nullptr ? Cast<ACharacterPlayerController>(Character->Controller) : Controller;
+	UpdateHUDCarriedAmmo();
+}
+
+int32 UCombatComponent::GetCarriedAmmo() const
+{
+	return EquippedWeapon ? CarriedAmmo.Get(EquippedWeapon->GetWeaponType()) : 0;
+}
+
+void UCombatComponent::UpdateHUDCarriedAmmo()
+{
+	if (Character == nullptr) return;
+
 	if (Controller)
 	{
-		Controller->SetHudCarriedAmmo(CarriedAmmo);
+		Controller->SetHudCarriedAmmo(GetCarriedAmmo());
 	}
 }
 
 void UCombatComponent::InitializeCarriedAmmo()
 {
-	CarriedAmmoMap.Emplace(EWeaponType::EWT_AssaultRifle, StartingARAmmo);
-	CarriedAmmoMap.Emplace(EWeaponType::EWT_Pistol, StartingPistolAmmo);
+	CarriedAmmo.Set(EWeaponType::EWT_AssaultRifle, StartingARAmmo);
+	CarriedAmmo.Set(EWeaponType::EWT_Pistol, StartingPistolAmmo);
+	CarriedAmmo.Set(EWeaponType::EWT_Shotgun, StartingShotgunAmmo);
 }
@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/CharacterComponents/LagCompensationComponent.h"
+#include "Character/MainCharacter.h"
+#include "Character/Subsystems/LagCompensationSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+
+ULagCompensationComponent::ULagCompensationComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// Mannequin right-side limbs point their X axis back towards the parent
+	Hitboxes = {
+		{FName("head"), EHitRegion::EHR_Head, 18.f, 11.f},
+		{FName("pelvis"), EHitRegion::EHR_Torso, 14.f, 16.f},
+		{FName("spine_02"), EHitRegion::EHR_Torso, 16.f, 16.f},
+		{FName("spine_03"), EHitRegion::EHR_Torso, 20.f, 17.f},
+		{FName("upperarm_l"), EHitRegion::EHR_Arm, 28.f, 6.f},
+		{FName("upperarm_r"), EHitRegion::EHR_Arm, -28.f, 6.f},
+		{FName("lowerarm_l"), EHitRegion::EHR_Arm, 26.f, 5.f},
+		{FName("lowerarm_r"), EHitRegion::EHR_Arm, -26.f, 5.f},
+		{FName("thigh_l"), EHitRegion::EHR_Leg, 42.f, 9.f},
+		{FName("thigh_r"), EHitRegion::EHR_Leg, -42.f, 9.f},
+		{FName("calf_l"), EHitRegion::EHR_Leg, 40.f, 7.f},
+		{FName("calf_r"), EHitRegion::EHR_Leg, -40.f, 7.f}
+	};
+}
+
+
+void ULagCompensationComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (Character == nullptr || !Character->HasAuthority()) return;
+
+	ResolveBoneIndices();
+	HistoryCapacity = FMath::Max(HistoryCapacity, 2);
+	SnapshotTimes.SetNumZeroed(HistoryCapacity);
+	SnapshotLocations.SetNumZeroed(HistoryCapacity);
+	SnapshotSegments.SetNum(HistoryCapacity * Hitboxes.Num());
+
+	ULagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>();
+	if (LagCompensation)
+	{
+		LagCompensation->RegisterComponent(this);
+	}
+}
+
+void ULagCompensationComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ULagCompensationSubsystem* LagCompensation = GetWorld() ? GetWorld()->GetSubsystem<ULagCompensationSubsystem>() : nullptr;
+	if (LagCompensation)
+	{
+		LagCompensation->UnregisterComponent(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ULagCompensationComponent::ResolveBoneIndices()
+{
+	BoneIndices.Reset(Hitboxes.Num());
+	for (const FHitboxDefinition& Hitbox : Hitboxes)
+	{
+		BoneIndices.Add(Character->GetMesh()->GetBoneIndex(Hitbox.BoneName));
+	}
+}
+
+void ULagCompensationComponent::RecordSnapshot(float ServerTime)
+{
+	if (Character == nullptr || SnapshotTimes.Num() == 0) return;
+
+	Head = (Head + 1) % HistoryCapacity;
+	NumSnapshots = FMath::Min(NumSnapshots + 1, HistoryCapacity);
+	SnapshotTimes[Head] = ServerTime;
+	SnapshotLocations[Head] = Character->GetActorLocation();
+
+	const USkeletalMeshComponent* Mesh = Character->GetMesh();
+	const int32 Base = Head * Hitboxes.Num();
+	for (int32 i = 0; i < Hitboxes.Num(); ++i)
+	{
+		if (BoneIndices[i] == INDEX_NONE) continue;
+
+		const FTransform BoneTransform = Mesh->GetBoneTransform(BoneIndices[i]);
+		FHitboxSegment& Segment = SnapshotSegments[Base + i];
+		Segment.Start = BoneTransform.GetLocation();
+		Segment.End = Segment.Start + BoneTransform.GetUnitAxis(EAxis::X) * Hitboxes[i].Length;
+	}
+}
+
+bool ULagCompensationComponent::FindSnapshotPair(float Time, int32& OutOlder, int32& OutNewer, float& OutAlpha) const
+{
+	if (NumSnapshots == 0) return false;
+
+	// Walk from newest to oldest until we pass the requested time
+	int32 Newer = Head;
+	for (int32 Step = 1; Step < NumSnapshots; ++Step)
+	{
+		const int32 Older = (Head - Step + HistoryCapacity) % HistoryCapacity;
+		if (SnapshotTimes[Older] <= Time)
+		{
+			const float Span = SnapshotTimes[Newer] - SnapshotTimes[Older];
+			OutOlder = Older;
+			OutNewer = Newer;
+			OutAlpha = Span > KINDA_SMALL_NUMBER ? FMath::Clamp((Time - SnapshotTimes[Older]) / Span, 0.f, 1.f) : 1.f;
+			return true;
+		}
+		Newer = Older;
+	}
+
+	// Older than anything recorded, or only one snapshot: clamp to the end of the buffer
+	OutOlder = Newer;
+	OutNewer = Newer;
+	OutAlpha = 1.f;
+	return true;
+}
+
+bool ULagCompensationComponent::IntersectRewound(float Time, const FVector& Start, const FVector& End,
+                                                 float& OutHitTime, FVector& OutHitLocation, EHitRegion& OutRegion) const
+{
+	int32 Older, Newer;
+	float Alpha;
+	if (!FindSnapshotPair(Time, Older, Newer, Alpha)) return false;
+
+	const FVector Location = FMath::Lerp(SnapshotLocations[Older], SnapshotLocations[Newer], Alpha);
+	if (FMath::PointDistToSegment(Location, Start, End) > BroadphaseRadius) return false;
+
+	const float ShotLength = FVector::Dist(Start, End);
+	if (ShotLength < KINDA_SMALL_NUMBER) return false;
+
+	bool bHit = false;
+	OutHitTime = 1.f;
+	const int32 OlderBase = Older * Hitboxes.Num();
+	const int32 NewerBase = Newer * Hitboxes.Num();
+	for (int32 i = 0; i < Hitboxes.Num(); ++i)
+	{
+		if (BoneIndices[i] == INDEX_NONE) continue;
+
+		const FHitboxSegment& OlderSegment = SnapshotSegments[OlderBase + i];
+		const FHitboxSegment& NewerSegment = SnapshotSegments[NewerBase + i];
+		const FVector AxisStart = FMath::Lerp(OlderSegment.Start, NewerSegment.Start, Alpha);
+		const FVector AxisEnd = FMath::Lerp(OlderSegment.End, NewerSegment.End, Alpha);
+
+		FVector ShotPoint;
+		FVector AxisPoint;
+		FMath::SegmentDistToSegmentSafe(Start, End, AxisStart, AxisEnd, ShotPoint, AxisPoint);
+		const float DistSquared = FVector::DistSquared(ShotPoint, AxisPoint);
+		const float Radius = Hitboxes[i].Radius;
+		if (DistSquared > Radius * Radius) continue;
+
+		// Back off from the closest approach to where the shot enters the capsule
+		const float EntryDistance = FMath::Max(FVector::Dist(Start, ShotPoint) - FMath::Sqrt(Radius * Radius - DistSquared), 0.f);
+		const float HitTime = EntryDistance / ShotLength;
+		if (HitTime < OutHitTime)
+		{
+			bHit = true;
+			OutHitTime = HitTime;
+			OutHitLocation = Start + (End - Start) * HitTime;
+			OutRegion = Hitboxes[i].Region;
+		}
+	}
+	return bHit;
+}
+
+bool ULagCompensationComponent::GetRewoundLocation(float Time, FVector& OutLocation) const
+{
+	int32 Older, Newer;
+	float Alpha;
+	if (!FindSnapshotPair(Time, Older, Newer, Alpha)) return false;
+
+	OutLocation = FMath::Lerp(SnapshotLocations[Older], SnapshotLocations[Newer], Alpha);
+	return true;
+}
+
+float ULagCompensationComponent::GetDamageMultiplier(EHitRegion Region) const
+{
+	switch (Region)
+	{
+	case EHitRegion::EHR_Head:
+		return HeadDamageMultiplier;
+	case EHitRegion::EHR_Arm:
+	case EHitRegion::EHR_Leg:
+		return LimbDamageMultiplier;
+	default:
+		return TorsoDamageMultiplier;
+	}
+}
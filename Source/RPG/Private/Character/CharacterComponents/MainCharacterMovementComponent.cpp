@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/CharacterComponents/MainCharacterMovementComponent.h"
+#include "Character/CharacterComponents/CombatComponent.h"
+#include "Character/MainCharacter.h"
+
+void FSavedMove_MainCharacter::Clear()
+{
+	Super::Clear();
+	bSavedWantsToAim = false;
+}
+
+uint8 FSavedMove_MainCharacter::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+	if (bSavedWantsToAim)
+	{
+		Result |= FLAG_Custom_0;
+	}
+	return Result;
+}
+
+bool FSavedMove_MainCharacter::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	if (bSavedWantsToAim != static_cast<FSavedMove_MainCharacter*>(NewMove.Get())->bSavedWantsToAim) return false;
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_MainCharacter::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (const UMainCharacterMovementComponent* Movement = Cast<UMainCharacterMovementComponent>(C->GetCharacterMovement()))
+	{
+		bSavedWantsToAim = Movement->WantsToAim();
+	}
+}
+
+void FSavedMove_MainCharacter::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	if (UMainCharacterMovementComponent* Movement = Cast<UMainCharacterMovementComponent>(C->GetCharacterMovement()))
+	{
+		Movement->SetWantsToAim(bSavedWantsToAim);
+	}
+}
+
+FNetworkPredictionData_Client_MainCharacter::FNetworkPredictionData_Client_MainCharacter(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_MainCharacter::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_MainCharacter());
+}
+
+FNetworkPredictionData_Client* UMainCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UMainCharacterMovementComponent* MutableThis = const_cast<UMainCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_MainCharacter(*this);
+	}
+	return ClientPredictionData;
+}
+
+float UMainCharacterMovementComponent::GetMaxSpeed() const
+{
+	const bool bWalking = MovementMode == MOVE_Walking || MovementMode == MOVE_NavWalking;
+	if (bWantsToAim && bWalking && !IsCrouching())
+	{
+		return MaxWalkSpeedAiming;
+	}
+	return Super::GetMaxSpeed();
+}
+
+void UMainCharacterMovementComponent::SetWantsToAim(bool bAim)
+{
+	bWantsToAim = bAim;
+}
+
+void UMainCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	const bool bAim = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+	const bool bChanged = bAim != static_cast<bool>(bWantsToAim);
+	bWantsToAim = bAim;
+
+	// The server's combat state follows the moves, so other clients see the aim pose
+	if (bChanged && CharacterOwner && CharacterOwner->GetLocalRole() == ROLE_Authority)
+	{
+		const AMainCharacter* MainCharacter = Cast<AMainCharacter>(CharacterOwner);
+		if (MainCharacter && MainCharacter->GetCombatComponent())
+		{
+			MainCharacter->GetCombatComponent()->SetAiming(bAim);
+		}
+	}
+}
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/CharacterComponents/ShotLog.h"
+#include "Character/CharacterComponents/CombatComponent.h"
+
+void FShotRecord::PostReplicatedAdd(const FShotLog& InArraySerializer)
+{
+	if (InArraySerializer.OwnerComponent)
+	{
+		InArraySerializer.OwnerComponent->PlayShotRecord(*this);
+	}
+}
+
+void FShotLog::AddShot(const FVector& HitTarget, float ServerTime, bool bAiming, uint16 SpreadSeed)
+{
+	if (Shots.Num() >= MaxShots)
+	{
+		Shots.RemoveAt(0, Shots.Num() - MaxShots + 1);
+		MarkArrayDirty();
+	}
+
+	FShotRecord& Record = Shots.AddDefaulted_GetRef();
+	Record.HitTarget = HitTarget;
+	Record.ServerTime = ServerTime;
+	Record.bAiming = bAiming;
+	Record.SpreadSeed = SpreadSeed;
+	MarkItemDirty(Record);
+}
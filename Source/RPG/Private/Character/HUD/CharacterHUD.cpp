@@ -5,11 +5,18 @@
 #include "Blueprint/UserWidget.h"
 #include "Character/HUD/Announcment.h"
 #include "Character/HUD/CharacterOverlay.h"
+#include "Character/PlayerController/CharacterPlayerController.h"
 
 void ACharacterHUD::BeginPlay()
 {
 	Super::BeginPlay();
 	//AddCharacterOverlay();
+
+	ACharacterPlayerController* CharacterController = Cast<ACharacterPlayerController>(GetOwningPlayerController());
+	if (CharacterController)
+	{
+		CharacterController->NotifyHUDReady(this);
+	}
 }
 
 void ACharacterHUD::AddCharacterOverlay()
@@ -34,6 +41,7 @@ void ACharacterHUD::AddAnnouncement()
 
 void ACharacterHUD::DrawHUD()
 {
+#if !UE_SERVER
 	Super::DrawHUD();
 
 	FVector2D ViewportSize;
@@ -70,6 +78,7 @@ void ACharacterHUD::DrawHUD()
 			DrawCrosshair(HUDPackage.CrosshairsBottom, ViewportCenter, Spread, HUDPackage.CrosshairColor);
 		}
 	}
+#endif
 }
 
 void ACharacterHUD::DrawCrosshair(UTexture2D* Texture, FVector2D ViewportCenter, FVector2D Spread, FLinearColor CrosshairColor)
@@ -5,22 +5,28 @@
 #include "Camera/CameraComponent.h"
 #include "EnhancedInputComponent.h"
 #include "Character/CharacterComponents/CombatComponent.h"
+#include "Character/CharacterComponents/LagCompensationComponent.h"
+#include "Character/CharacterComponents/MainCharacterMovementComponent.h"
 #include "Character/GameMode/MainGameMode.h"
 #include "Character/PlayerController/CharacterPlayerController.h"
-#include "Character/PlayerState/CharacterPlayerState.h"
+#include "Character/Subsystems/CharacterTickSubsystem.h"
+#include "Character/Subsystems/DamagePipelineSubsystem.h"
 #include "Character/Weapon/Weapon.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/WidgetComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetMathLibrary.h"
 #include "Net/UnrealNetwork.h"
 #include "RPG/RPG.h"
 
-AMainCharacter::AMainCharacter()
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gameplay Server RPCs Received"), STAT_ServerRPCsReceived, STATGROUP_RPG);
+
+AMainCharacter::AMainCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UMainCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// Ticked in a batch by the character tick subsystem
+	PrimaryActorTick.bCanEverTick = false;
 
 	bUseControllerRotationPitch = false;
 	bUseControllerRotationYaw = false;
@@ -43,13 +49,20 @@ AMainCharacter::AMainCharacter()
 	CombatComponent = CreateDefaultSubobject<UCombatComponent>(TEXT("CombatComponent"));
 	CombatComponent->SetIsReplicated(true);
 
+	LagCompensation = CreateDefaultSubobject<ULagCompensationComponent>(TEXT("LagCompensation"));
+
 	GetCharacterMovement()->NavAgentProps.bCanCrouch = true;
 	GetCapsuleComponent()->SetCollisionResponseToChannel(ECC_Camera, ECR_Ignore);
+	GetCapsuleComponent()->SetCollisionResponseToChannel(ECC_WeaponTrace, ECR_Ignore);
 	GetMesh()->SetCollisionObjectType(ECC_SkeletalMesh);
 	GetMesh()->SetCollisionResponseToChannel(ECC_Camera, ECR_Ignore);
 	GetMesh()->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
+	GetMesh()->SetCollisionResponseToChannel(ECC_WeaponTrace, ECR_Block);
 	GetCharacterMovement()->RotationRate = FRotator(0.f, 0.f, 850.f);
 
+	RightHandSocket = MeshSockets.Add(FName("RightHandSocket"));
+	RightHandBone = MeshSockets.Add(FName("hand_r"));
+
 	TurningInPlace = ETurningInPlace::ETIP_NotTurning;
 	SetNetUpdateFrequency(66.f);
 	SetMinNetUpdateFrequency(33.f);
@@ -135,6 +148,11 @@ FVector AMainCharacter::GetHitTarget() const
 	return CombatComponent->HitTarget;
 }
 
+UMainCharacterMovementComponent* AMainCharacter::GetMainCharacterMovement() const
+{
+	return CastChecked<UMainCharacterMovementComponent>(GetCharacterMovement());
+}
+
 ECombatState AMainCharacter::GetCombatState() const
 {
 	if (CombatComponent == nullptr) return ECombatState::ECS_MAX;
@@ -144,8 +162,7 @@ ECombatState AMainCharacter::GetCombatState() const
 void AMainCharacter::OnRep_ReplicatedMovement()
 {
 	Super::OnRep_ReplicatedMovement();
-	SimProxiesTurn();
-	TimeSinceLastMovementReplication = 0.f;
+	ProxySnapshots.Add(GetWorld()->GetTimeSeconds(), GetReplicatedMovement().Rotation.Yaw, FRotator::NormalizeAxis(GetBaseAimRotation().Pitch));
 }
 
 void AMainCharacter::Destroyed()
@@ -158,6 +175,28 @@ void AMainCharacter::Destroyed()
 	{
 		CombatComponent->EquippedWeapon->Destroy();
 	}
+	if (CombatComponent && HasAuthority())
+	{
+		CombatComponent->DestroyHolsteredWeapons();
+	}
+}
+
+void AMainCharacter::PreRegisterAllComponents()
+{
+	Super::PreRegisterAllComponents();
+
+	// Created in every build so the subobjects match, but a dedicated server has nothing to draw it on
+	if (OverheadWidget && IsNetMode(NM_DedicatedServer))
+	{
+		OverheadWidget->bAutoRegister = false;
+	}
+
+	// Hitboxes are recorded from the bones and weapon traces hit the mesh, so the server needs an up to
+	// date pose even for characters it never renders
+	if (GetMesh() && GetNetMode() != NM_Client)
+	{
+		GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	}
 }
 
 void AMainCharacter::BeginPlay()
@@ -169,46 +208,72 @@ void AMainCharacter::BeginPlay()
 	{
 		OnTakeAnyDamage.AddDynamic(this, &AMainCharacter::ReceiveDamage);
 	}
+
+	bBlueprintImplementsTick = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AActor, ReceiveTick));
+	UCharacterTickSubsystem* CharacterTick = GetWorld()->GetSubsystem<UCharacterTickSubsystem>();
+	if (CharacterTick)
+	{
+		CharacterTick->RegisterCharacter(this);
+	}
 }
 
-void AMainCharacter::Tick(float DeltaTime)
+void AMainCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	UCharacterTickSubsystem* CharacterTick = GetWorld() ? GetWorld()->GetSubsystem<UCharacterTickSubsystem>() : nullptr;
+	if (CharacterTick)
+	{
+		CharacterTick->UnregisterCharacter(this);
+	}
 
-	RotateInPlace(DeltaTime);
-	HideCameraIfCharacterClose();
-	PollInit();
+	Super::EndPlay(EndPlayReason);
 }
 
-void AMainCharacter::RotateInPlace(float DeltaTime)
+void AMainCharacter::BatchedTick(float DeltaTime)
 {
-	if (bDisableGameplay)
+	HideCameraIfCharacterClose();
+
+	if (HasAuthority())
 	{
-		bUseControllerRotationYaw = false;
-		TurningInPlace = ETurningInPlace::ETIP_NotTurning;
-		return;
+		UpdateServerRPCRate();
 	}
-	
-	if (GetLocalRole() > ROLE_SimulatedProxy && IsLocallyControlled())
+	if (CombatComponent)
 	{
-		AimOffset(DeltaTime);
-
-		// if (CombatComponent->EquippedWeapon)
-		// {
-		// 	CombatComponent->EquippedWeapon->SetActorRotation(GetControlRotation());
-		// }
+		CombatComponent->BatchedTick(DeltaTime);
 	}
-	else
+	if (bBlueprintImplementsTick)
 	{
-		TimeSinceLastMovementReplication += DeltaTime;
-		if (TimeSinceLastMovementReplication > 0.25f)
-		{
-			OnRep_ReplicatedMovement();
-		}
-		CalculateAO_Pitch();
+		ReceiveTick(DeltaTime);
+	}
+}
+
+void AMainCharacter::BindController(ACharacterPlayerController* InController)
+{
+	MainCharacterPlayerController = InController;
+	if (CombatComponent)
+	{
+		CombatComponent->Controller = InController;
+		CombatComponent->HUD = InController ? InController->GetCharacterHUD() : nullptr;
 	}
 }
 
+void AMainCharacter::CountServerRPC()
+{
+	++ServerRPCCount;
+	INC_DWORD_STAT(STAT_ServerRPCsReceived);
+}
+
+void AMainCharacter::UpdateServerRPCRate()
+{
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float Window = Now - ServerRPCWindowStart;
+	if (Window < 1.f) return;
+
+	ServerRPCRate = ServerRPCCount / Window;
+	ServerRPCCount = 0;
+	ServerRPCWindowStart = Now;
+	UE_LOG(LogRPG, Verbose, TEXT("%s: %.1f gameplay server RPCs/s"), *GetName(), ServerRPCRate);
+}
+
 void AMainCharacter::Move(const FInputActionValue& Value)
 {
 	if (bDisableGameplay) return;
@@ -269,8 +334,19 @@ void AMainCharacter::Equip()
 	}
 }
 
+void AMainCharacter::SwapWeaponButtonPressed()
+{
+	if (bDisableGameplay) return;
+
+	if (CombatComponent)
+	{
+		CombatComponent->SwapToNextWeapon();
+	}
+}
+
 void AMainCharacter::ServerEquipButtonPressed_Implementation()
 {
+	CountServerRPC();
 	if (CombatComponent)
 	{
 		CombatComponent->EquipWeapon(OverlappingWeapon);
@@ -305,7 +381,7 @@ void AMainCharacter::AimButtonPressed()
 {
 	if (bDisableGameplay) return;
 
-	if (CombatComponent)
+	if (SetInputButton(EInputButton::EIB_Aim, true) && CombatComponent)
 	{
 		CombatComponent->SetAiming(true);
 	}
@@ -315,7 +391,7 @@ void AMainCharacter::AimButtonReleased()
 {
 	if (bDisableGameplay) return;
 
-	if (CombatComponent)
+	if (SetInputButton(EInputButton::EIB_Aim, false) && CombatComponent)
 	{
 		CombatComponent->SetAiming(false);
 	}
@@ -325,7 +401,7 @@ void AMainCharacter::FireButtonPressed()
 {
 	if (bDisableGameplay) return;
 
-	if (CombatComponent)
+	if (SetInputButton(EInputButton::EIB_Fire, true) && CombatComponent)
 	{
 		CombatComponent->FireButtonPressed(true);
 	}
@@ -335,33 +411,25 @@ void AMainCharacter::FireButtonReleased()
 {
 	if (bDisableGameplay) return;
 
-	if (CombatComponent)
+	if (SetInputButton(EInputButton::EIB_Fire, false) && CombatComponent)
 	{
 		CombatComponent->FireButtonPressed(false);
 	}
 }
 
-void AMainCharacter::CalculateAO_Pitch()
+bool AMainCharacter::SetInputButton(EInputButton Button, bool bPressed)
 {
-	// AO_Pitch = GetBaseAimRotation().Pitch;
-	// if (AO_Pitch > 90.f && !IsLocallyControlled())
-	// {
-	// 	// map pitch from [270, 360) to [-90, 0)
-	// 	FVector2d InRange(270.f, 360.f);
-	// 	FVector2d OutRange(-90.f, 0.f);
-	// 	AO_Pitch = FMath::GetMappedRangeValueClamped(InRange, OutRange, AO_Pitch);
-	// }
-	
-	AO_Pitch = GetBaseAimRotation().GetNormalized().Pitch;
+	if (EnumHasAnyFlags(InputButtons, Button) == bPressed) return false;
 
-
-}
-
-float AMainCharacter::CalculateSpeed()
-{
-	FVector Velocity = GetVelocity();
-	Velocity.Z = 0.f;
-	return Velocity.Size();
+	if (bPressed)
+	{
+		InputButtons |= Button;
+	}
+	else
+	{
+		InputButtons &= ~Button;
+	}
+	return true;
 }
 
 void AMainCharacter::OnRep_Health()
@@ -372,32 +440,17 @@ void AMainCharacter::OnRep_Health()
 
 void AMainCharacter::UpdateHUDHealth()
 {
-	MainCharacterPlayerController = MainCharacterPlayerController == nullptr
-		                                ? Cast<ACharacterPlayerController>(Controller)
-		                                : MainCharacterPlayerController;
 	if (MainCharacterPlayerController)
 	{
 		MainCharacterPlayerController->SetHudHealth(Health, MaxHealth);
 	}
 }
 
-void AMainCharacter::PollInit()
-{
-	if (PlayerState == nullptr)
-	{
-		PlayerState = GetPlayerState<ACharacterPlayerState>();
-		if (PlayerState)
-		{
-			PlayerState->AddToScore(0.f);
-		}
-	}
-}
-
 void AMainCharacter::Elim(const FVector& HitDirection)
 {
-	if (CombatComponent && CombatComponent->EquippedWeapon)
+	if (CombatComponent)
 	{
-		CombatComponent->EquippedWeapon->Dropped();
+		CombatComponent->DiscardLoadout();
 	}
 	MulticastElim(HitDirection);
 	
@@ -422,6 +475,7 @@ void AMainCharacter::MulticastElim_Implementation(const FVector& HitDirection)
 
 	//Disable movement
 	bDisableGameplay = true;
+	SetInputButton(EInputButton::EIB_Fire, false);
 	if (CombatComponent)
 	{
 		CombatComponent->FireButtonPressed(false);
@@ -442,93 +496,6 @@ void AMainCharacter::ElimTimerFinished()
 	}
 }
 
-void AMainCharacter::AimOffset(float DeltaTime)
-{
-	if (CombatComponent && CombatComponent->EquippedWeapon == nullptr) return;
-	float Speed = CalculateSpeed();
-	bool bIsInAir = GetCharacterMovement()->IsFalling();
-
-	if (Speed == 0.f && !bIsInAir)
-	{
-		bRotateRootBone = true;
-		FRotator CurrentAimRotation = FRotator(0.f, GetBaseAimRotation().Yaw, 0.f);
-		FRotator DeltaAimRotation = UKismetMathLibrary::NormalizedDeltaRotator(CurrentAimRotation, StartingAimRotation);
-		AO_Yaw = DeltaAimRotation.Yaw;
-		if (TurningInPlace == ETurningInPlace::ETIP_NotTurning)
-		{
-			InterpAO_Yaw = AO_Yaw;
-		}
-		bUseControllerRotationYaw = true;
-		TurnInPlace(DeltaTime);
-	}
-	if (Speed > 0.f || bIsInAir)
-	{
-		bRotateRootBone = false;
-		StartingAimRotation = FRotator(0.f, GetBaseAimRotation().Yaw, 0.f);
-		AO_Yaw = 0.f;
-		bUseControllerRotationYaw = true;
-		TurningInPlace = ETurningInPlace::ETIP_NotTurning;
-	}
-	CalculateAO_Pitch();
-}
-
-void AMainCharacter::SimProxiesTurn()
-{
-	if (CombatComponent == nullptr || CombatComponent->EquippedWeapon == nullptr) return;
-
-	bRotateRootBone = false;
-	float Speed = CalculateSpeed();
-	if (Speed > 0.f)
-	{
-		TurningInPlace = ETurningInPlace::ETIP_NotTurning;
-		return;
-	}
-
-	ProxyRotationLastFrame = ProxyRotation;
-	ProxyRotation = GetActorRotation();
-	ProxyYaw = UKismetMathLibrary::NormalizedDeltaRotator(ProxyRotation, ProxyRotationLastFrame).Yaw;
-
-	if (FMath::Abs(ProxyYaw) > TurnThreshold)
-	{
-		if (ProxyYaw > TurnThreshold)
-		{
-			TurningInPlace = ETurningInPlace::ETIP_Right;
-		}
-		else if (ProxyYaw < -TurnThreshold)
-		{
-			TurningInPlace = ETurningInPlace::ETIP_Left;
-		}
-		else
-		{
-			TurningInPlace = ETurningInPlace::ETIP_NotTurning;
-		}
-		return;
-	}
-	TurningInPlace = ETurningInPlace::ETIP_NotTurning;
-}
-
-void AMainCharacter::TurnInPlace(float DeltaTime)
-{
-	if (AO_Yaw > 90.f)
-	{
-		TurningInPlace = ETurningInPlace::ETIP_Right;
-	}
-	else if (AO_Yaw < -90.f)
-	{
-		TurningInPlace = ETurningInPlace::ETIP_Left;
-	}
-	if (TurningInPlace != ETurningInPlace::ETIP_NotTurning)
-	{
-		InterpAO_Yaw = FMath::FInterpTo(InterpAO_Yaw, 0.f, DeltaTime, 2.f);
-		AO_Yaw = InterpAO_Yaw;
-		if (FMath::Abs(AO_Yaw) < 15.f)
-		{
-			TurningInPlace = ETurningInPlace::ETIP_NotTurning;
-			StartingAimRotation = FRotator(0.f, GetBaseAimRotation().Yaw, 0.f);
-		}
-	}
-}
-
 void AMainCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
@@ -545,30 +512,37 @@ void AMainCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompo
 	}
 	UEnhancedInputComponent* Input = Cast<UEnhancedInputComponent>(PlayerInputComponent);
 
+	// One-shot actions fire once per press. Held buttons go through SetInputButton, which drops repeats
+
 	Input->BindAction(MoveAction, ETriggerEvent::Triggered, this, &AMainCharacter::Move);
 	Input->BindAction(LookAction, ETriggerEvent::Triggered, this, &AMainCharacter::Look);
 	Input->BindAction(JumpAction, ETriggerEvent::Triggered, this, &AMainCharacter::Jump);
-	Input->BindAction(EquipAction, ETriggerEvent::Triggered, this, &AMainCharacter::Equip);
-	Input->BindAction(CrouchAction, ETriggerEvent::Triggered, this, &AMainCharacter::Crouched);
+	Input->BindAction(EquipAction, ETriggerEvent::Started, this, &AMainCharacter::Equip);
+	Input->BindAction(CrouchAction, ETriggerEvent::Started, this, &AMainCharacter::Crouched);
 	Input->BindAction(AimButtonPressedAction, ETriggerEvent::Triggered, this, &AMainCharacter::AimButtonPressed);
 	Input->BindAction(AimButtonReleasedAction, ETriggerEvent::Triggered, this, &AMainCharacter::AimButtonReleased);
 	Input->BindAction(FireButtonPressedAction, ETriggerEvent::Triggered, this, &AMainCharacter::FireButtonPressed);
 	Input->BindAction(FireButtonReleasedAction, ETriggerEvent::Triggered, this, &AMainCharacter::FireButtonReleased);
-	Input->BindAction(ReloadButtonPressedAction, ETriggerEvent::Triggered, this, &AMainCharacter::ReloadButtonPressed);
+	Input->BindAction(ReloadButtonPressedAction, ETriggerEvent::Started, this, &AMainCharacter::ReloadButtonPressed);
+	Input->BindAction(SwapWeaponAction, ETriggerEvent::Started, this, &AMainCharacter::SwapWeaponButtonPressed);
 }
 
 void AMainCharacter::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
-	CombatComponent->PrimaryComponentTick.bCanEverTick = true;
 	if (CombatComponent)
 	{
 		CombatComponent->Character = this;
 	}
+	if (LagCompensation)
+	{
+		LagCompensation->Character = this;
+	}
 }
 
 void AMainCharacter::PlayFireMontage(bool bAiming)
 {
+#if !UE_SERVER
 	if (CombatComponent == nullptr || CombatComponent->EquippedWeapon == nullptr) return;
 
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
@@ -578,6 +552,7 @@ void AMainCharacter::PlayFireMontage(bool bAiming)
 		FName SectionName = bAiming ? FName("RifleAim") : FName("RifleHip");
 		AnimInstance->Montage_JumpToSection(SectionName);
 	}
+#endif
 }
 
 void AMainCharacter::PlayReloadMontage()
@@ -598,6 +573,9 @@ void AMainCharacter::PlayReloadMontage()
 		case EWeaponType::EWT_Pistol:
 			SectionName = FName("Rifle");
 			break;
+		case EWeaponType::EWT_Shotgun:
+			SectionName = FName("Rifle");
+			break;
 		}
 
 
@@ -685,6 +663,7 @@ void AMainCharacter::RagdollDeath(const FVector& HitDirection)
 
 void AMainCharacter::PlayHitReactMontage()
 {
+#if !UE_SERVER
 	//if (Combat == nullptr || Combat->EquippedWeapon == nullptr) return;
 
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
@@ -694,10 +673,20 @@ void AMainCharacter::PlayHitReactMontage()
 		FName SectionName("FromFront");
 		AnimInstance->Montage_JumpToSection(SectionName);
 	}
+#endif
 }
 
 void AMainCharacter::ReceiveDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType,
                                    class AController* InstigatorController, AActor* DamageCauser)
+{
+	UDamagePipelineSubsystem* DamagePipeline = GetWorld()->GetSubsystem<UDamagePipelineSubsystem>();
+	if (DamagePipeline)
+	{
+		DamagePipeline->QueueDamage(this, Damage, InstigatorController, DamageCauser);
+	}
+}
+
+void AMainCharacter::ApplyFrameDamage(float Damage, AController* InstigatorController, AActor* DamageCauser)
 {
 	Health = FMath::Clamp(Health - Damage, 0.f, MaxHealth);
 	UpdateHUDHealth();
@@ -708,13 +697,19 @@ void AMainCharacter::ReceiveDamage(AActor* DamagedActor, float Damage, const UDa
 		AMainGameMode* MainGameMode = GetWorld()->GetAuthGameMode<AMainGameMode>();
 		if (MainGameMode && !IsElimmed())
 		{
-			FVector HitDirection = (DamageCauser->GetActorLocation() - GetActorLocation()).GetSafeNormal();
-
-			MainCharacterPlayerController = MainCharacterPlayerController == nullptr
-				                                ? Cast<ACharacterPlayerController>(Controller)
-				                                : MainCharacterPlayerController;
+			FVector HitDirection = DamageCauser ? (DamageCauser->GetActorLocation() - GetActorLocation()).GetSafeNormal() : FVector::ZeroVector;
 			ACharacterPlayerController* AttackerController = Cast<ACharacterPlayerController>(InstigatorController);
 			MainGameMode->PlayerEliminated(this, MainCharacterPlayerController, AttackerController, HitDirection);
 		}
 	}
 }
+
+const USkeletalMeshSocket* AMainCharacter::GetRightHandSocket()
+{
+	return MeshSockets.GetSocket(GetMesh(), RightHandSocket);
+}
+
+bool AMainCharacter::GetRightHandBoneTransform(FTransform& OutTransform)
+{
+	return MeshSockets.GetTransform(GetMesh(), RightHandBone, OutTransform);
+}
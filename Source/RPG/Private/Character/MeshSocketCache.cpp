@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/MeshSocketCache.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+
+int32 FMeshSocketCache::Add(FName Name)
+{
+	FEntry Entry;
+	Entry.Name = Name;
+	ResolvedMesh.Reset();
+	return Entries.Add(Entry);
+}
+
+void FMeshSocketCache::Resolve(const USkeletalMeshComponent* Mesh)
+{
+	const USkeletalMesh* MeshAsset = Mesh->GetSkeletalMeshAsset();
+	ResolvedMesh = MeshAsset;
+
+	for (FEntry& Entry : Entries)
+	{
+		Entry.Socket = MeshAsset ? MeshAsset->FindSocket(Entry.Name) : nullptr;
+		if (Entry.Socket)
+		{
+			Entry.BoneIndex = Mesh->GetBoneIndex(Entry.Socket->BoneName);
+			Entry.LocalTransform = Entry.Socket->GetSocketLocalTransform();
+		}
+		else
+		{
+			Entry.BoneIndex = Mesh->GetBoneIndex(Entry.Name);
+			Entry.LocalTransform = FTransform::Identity;
+		}
+	}
+}
+
+const FMeshSocketCache::FEntry* FMeshSocketCache::Find(const USkeletalMeshComponent* Mesh, int32 Handle)
+{
+	if (Mesh == nullptr || !Entries.IsValidIndex(Handle)) return nullptr;
+
+	// A different (or first) mesh: resolve every name again
+	if (!ResolvedMesh.IsValid() || ResolvedMesh.Get() != Mesh->GetSkeletalMeshAsset())
+	{
+		Resolve(Mesh);
+	}
+	return &Entries[Handle];
+}
+
+const USkeletalMeshSocket* FMeshSocketCache::GetSocket(const USkeletalMeshComponent* Mesh, int32 Handle)
+{
+	const FEntry* Entry = Find(Mesh, Handle);
+	return Entry ? Entry->Socket : nullptr;
+}
+
+int32 FMeshSocketCache::GetBoneIndex(const USkeletalMeshComponent* Mesh, int32 Handle)
+{
+	const FEntry* Entry = Find(Mesh, Handle);
+	return Entry ? Entry->BoneIndex : INDEX_NONE;
+}
+
+bool FMeshSocketCache::GetTransform(const USkeletalMeshComponent* Mesh, int32 Handle, FTransform& OutTransform)
+{
+	const FEntry* Entry = Find(Mesh, Handle);
+	if (Entry == nullptr || Entry->BoneIndex == INDEX_NONE) return false;
+
+	OutTransform = Entry->LocalTransform * Mesh->GetBoneTransform(Entry->BoneIndex);
+	return true;
+}
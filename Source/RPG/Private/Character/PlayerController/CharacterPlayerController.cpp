@@ -21,6 +21,7 @@ void ACharacterPlayerController::BeginPlay()
 {
 	Super::BeginPlay();
 	CharacterHUD = Cast<ACharacterHUD>(GetHUD());
+	UpdatePlayerBindings();
 	ServerCheckMatchState();
 }
 
@@ -29,7 +30,6 @@ void ACharacterPlayerController::Tick(float DeltaTime)
 	Super::Tick(DeltaTime);
 	SetHudTime();
 	CheckTimeSync(DeltaTime);
-	PollInit();
 }
 
 void ACharacterPlayerController::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
@@ -80,21 +80,60 @@ void ACharacterPlayerController::ClientJoinMidgame_Implementation(FName StateOfM
 	}
 }
 
-void ACharacterPlayerController::OnPossess(APawn* InPawn)
+void ACharacterPlayerController::SetPawn(APawn* InPawn)
 {
-	Super::OnPossess(InPawn);
+	Super::SetPawn(InPawn);
+	UpdatePlayerBindings();
+}
+
+void ACharacterPlayerController::OnRep_PlayerState()
+{
+	Super::OnRep_PlayerState();
+	UpdatePlayerBindings();
+}
+
+void ACharacterPlayerController::NotifyHUDReady(ACharacterHUD* HUD)
+{
+	CharacterHUD = HUD;
+	UpdatePlayerBindings();
+}
+
+void ACharacterPlayerController::UpdatePlayerBindings()
+{
+	AMainCharacter* NewCharacter = Cast<AMainCharacter>(GetPawn());
+	if (MainCharacter && MainCharacter != NewCharacter)
+	{
+		MainCharacter->BindController(nullptr);
+	}
+	MainCharacter = NewCharacter;
+	CharacterPlayerState = GetPlayerState<ACharacterPlayerState>();
 
-	AMainCharacter* MainCharacter = Cast<AMainCharacter>(InPawn);
 	if (MainCharacter)
 	{
-		SetHudHealth(MainCharacter->GetHealth(), MainCharacter->GetMaxHealth());
+		MainCharacter->BindController(this);
+	}
+	if (CharacterPlayerState)
+	{
+		CharacterPlayerState->SetCharacterController(this);
 	}
+
+	const bool bReady = IsLocalController() && MainCharacter && CharacterPlayerState && CharacterHUD && CharacterHUD->CharacterOverlay;
+	if (!bReady) return;
+	if (ReadyCharacter == MainCharacter && ReadyOverlay == CharacterHUD->CharacterOverlay) return;
+
+	ReadyCharacter = MainCharacter;
+	ReadyOverlay = CharacterHUD->CharacterOverlay;
+	OnPlayerReady();
 }
 
-void ACharacterPlayerController::SetHudHealth(float Health, float MaxHealth)
+void ACharacterPlayerController::OnPlayerReady()
 {
-	CharacterHUD = CharacterHUD == nullptr ? Cast<ACharacterHUD>(GetHUD()) : CharacterHUD;
+	SetHudHealth(MainCharacter->GetHealth(), MainCharacter->GetMaxHealth());
+	SetHudScore(CharacterPlayerState->GetScore());
+}
 
+void ACharacterPlayerController::SetHudHealth(float Health, float MaxHealth)
+{
 	bool bHudValid = CharacterHUD && CharacterHUD->CharacterOverlay;
 	
 	if (bHudValid)
@@ -104,18 +143,10 @@ void ACharacterPlayerController::SetHudHealth(float Health, float MaxHealth)
 		FString HealthText = FString::Printf(TEXT("%d/%d"), FMath::CeilToInt(Health), FMath::CeilToInt(MaxHealth));
 		CharacterHUD->CharacterOverlay->HealthText->SetText(FText::FromString(HealthText));
 	}
-	else
-	{
-		bInitializeCharacterOverlay = true;
-		HudHealth = Health;
-		HudMaxHealth = MaxHealth;
-	}
 }
 
 void ACharacterPlayerController::SetHudScore(float Score)
 {
-	CharacterHUD = CharacterHUD == nullptr ? Cast<ACharacterHUD>(GetHUD()) : CharacterHUD;
-
 	bool bHudValid = CharacterHUD && CharacterHUD->CharacterOverlay && CharacterHUD->CharacterOverlay->ScoreAmount;
 
 	if (bHudValid)
@@ -123,17 +154,10 @@ void ACharacterPlayerController::SetHudScore(float Score)
 		FString ScoreText = FString::Printf(TEXT("%d"), FMath::FloorToInt(Score));
 		CharacterHUD->CharacterOverlay->ScoreAmount->SetText(FText::FromString(ScoreText));
 	}
-	else
-	{
-		bInitializeCharacterOverlay = true;
-		HudScore = Score;
-	}
 }
 
 void ACharacterPlayerController::SetHudWeaponAmmo(int32 Ammo)
 {
-	CharacterHUD = CharacterHUD == nullptr ? Cast<ACharacterHUD>(GetHUD()) : CharacterHUD;
-
 	bool bHudValid = CharacterHUD && CharacterHUD->CharacterOverlay && CharacterHUD->CharacterOverlay->WeaponAmmoAmount ;
 
 	if (bHudValid)
@@ -145,8 +169,6 @@ void ACharacterPlayerController::SetHudWeaponAmmo(int32 Ammo)
 
 void ACharacterPlayerController::SetHudCarriedAmmo(int32 Ammo)
 {
-	CharacterHUD = CharacterHUD == nullptr ? Cast<ACharacterHUD>(GetHUD()) : CharacterHUD;
-
 	bool bHudValid = CharacterHUD && CharacterHUD->CharacterOverlay && CharacterHUD->CharacterOverlay->CarriedAmmoAmount; ;
 
 	if (bHudValid)
@@ -158,8 +180,6 @@ void ACharacterPlayerController::SetHudCarriedAmmo(int32 Ammo)
 
 void ACharacterPlayerController::SetHudMatchCountdown(float CountdownTime)
 {
-	CharacterHUD = CharacterHUD == nullptr ? Cast<ACharacterHUD>(GetHUD()) : CharacterHUD;
-
 	bool bHudValid = CharacterHUD && CharacterHUD->CharacterOverlay && CharacterHUD->CharacterOverlay->MatchCountdownText;
 
 	if (bHudValid)
@@ -179,8 +199,6 @@ void ACharacterPlayerController::SetHudMatchCountdown(float CountdownTime)
 
 void ACharacterPlayerController::SetHudAnnouncementCountdown(float CountdownTime)
 {
-	CharacterHUD = CharacterHUD == nullptr ? Cast<ACharacterHUD>(GetHUD()) : CharacterHUD;
-
 	bool bHudValid = CharacterHUD && CharacterHUD->Announcement && CharacterHUD->Announcement->WarmupTime;
 
 	if (bHudValid)
@@ -229,22 +247,6 @@ void ACharacterPlayerController::SetHudTime()
 	CountdownInt = SecondsLeft;
 }
 
-void ACharacterPlayerController::PollInit()
-{
-	if (CharacterOverlay == nullptr)
-	{
-		if (CharacterHUD && CharacterHUD->CharacterOverlay)
-		{
-			CharacterOverlay = CharacterHUD->CharacterOverlay;
-			if (CharacterOverlay)
-			{
-				SetHudHealth(HudHealth, HudMaxHealth);
-				SetHudScore(HudScore);
-			}
-		}
-	}
-}
-
 void ACharacterPlayerController::ServerRequestServerTime_Implementation(float TimeOfClientRequest)
 {
 	float ServerTimeOfReceipt = GetWorld()->GetTimeSeconds();
@@ -255,7 +257,8 @@ void ACharacterPlayerController::ClientReportServerTime_Implementation(float Tim
 	float TimeServerReceivedClientRequest)
 {
 	float RoundTripTime = GetWorld()->GetTimeSeconds() - TimeOfClientRequest;
-	float CurrentServerTime = (0.5f * RoundTripTime) + TimeServerReceivedClientRequest;
+	SingleTripTime = 0.5f * RoundTripTime;
+	float CurrentServerTime = SingleTripTime + TimeServerReceivedClientRequest;
 	ClientServerDelta = CurrentServerTime - GetWorld()->GetTimeSeconds();
 }
 
@@ -302,7 +305,6 @@ void ACharacterPlayerController::OnRep_MatchState()
 
 void ACharacterPlayerController::HandleMatchHasStarted()
 {
-	CharacterHUD = CharacterHUD == nullptr ? Cast<ACharacterHUD>(GetHUD()) : CharacterHUD;
 	if (CharacterHUD)
 	{
 		CharacterHUD->AddCharacterOverlay();
@@ -310,12 +312,12 @@ void ACharacterPlayerController::HandleMatchHasStarted()
 		{
 			CharacterHUD->Announcement->SetVisibility(ESlateVisibility::Hidden);
 		}
+		UpdatePlayerBindings();
 	}
 }
 
 void ACharacterPlayerController::HandleCooldown()
 {
-	CharacterHUD = CharacterHUD == nullptr ? Cast<ACharacterHUD>(GetHUD()) : CharacterHUD;
 	if (CharacterHUD)
 	{
 		CharacterHUD->CharacterOverlay->RemoveFromParent();
@@ -326,8 +328,7 @@ void ACharacterPlayerController::HandleCooldown()
 			CharacterHUD->Announcement->AnnouncementText->SetText(FText::FromString(AnnouncementText));
 
 			ACharacterGameState* GameState = Cast <ACharacterGameState>(UGameplayStatics::GetGameState(this));
-			ACharacterPlayerState* PlayerState = GetPlayerState<ACharacterPlayerState>();
-			if (GameState && PlayerState)
+			if (GameState && CharacterPlayerState)
 			{
 				TArray<ACharacterPlayerState*> TopPlayers = GameState->TopScoringPlayers;
 				FString InfoTextString;
@@ -335,7 +336,7 @@ void ACharacterPlayerController::HandleCooldown()
 				{
 					InfoTextString = FString("No winner");
 				}
-				else if (TopPlayers.Num() == 1 && TopPlayers[0] == PlayerState)
+				else if (TopPlayers.Num() == 1 && TopPlayers[0] == CharacterPlayerState)
 				{
 					InfoTextString = FString("You are the winner");
 				}
@@ -355,7 +356,6 @@ void ACharacterPlayerController::HandleCooldown()
 			}
 		}
 	}
-	AMainCharacter* MainCharacter = Cast<AMainCharacter>(GetPawn());
 	if (MainCharacter && MainCharacter->GetCombatComponent())
 	{
 		MainCharacter->bDisableGameplay = true;
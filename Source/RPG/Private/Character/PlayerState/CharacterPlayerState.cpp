@@ -2,7 +2,6 @@
 
 
 #include "Character/PlayerState/CharacterPlayerState.h"
-#include "Character/MainCharacter.h"
 #include "Character/PlayerController/CharacterPlayerController.h"
 #include "Net/UnrealNetwork.h"
 
@@ -15,14 +14,9 @@ void ACharacterPlayerState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>
 void ACharacterPlayerState::AddToScore(float ScoreAmount)
 {
 	SetScore(GetScore() + ScoreAmount);
-	Character = Character == nullptr ? Cast<AMainCharacter>(GetPawn()) : Character;
-	if (Character)
+	if (CharacterController)
 	{
-		CharacterController = CharacterController == nullptr ? Cast<ACharacterPlayerController>(Character->Controller) : CharacterController;
-		if (CharacterController)
-		{
-			CharacterController->SetHudScore(GetScore());
-		}
+		CharacterController->SetHudScore(GetScore());
 	}
 }
 
@@ -30,13 +24,8 @@ void ACharacterPlayerState::OnRep_Score()
 {
 	Super::OnRep_Score();
 	
-	Character = Character == nullptr ? Cast<AMainCharacter>(GetPawn()) : Character;
-	if (Character)
+	if (CharacterController)
 	{
-		CharacterController = CharacterController == nullptr ? Cast<ACharacterPlayerController>(Character->Controller) : CharacterController;
-		if (CharacterController)
-		{
-			CharacterController->SetHudScore(GetScore());
-		}
+		CharacterController->SetHudScore(GetScore());
 	}
 }
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/RotationSnapshotBuffer.h"
+
+FRotationSnapshotBuffer::FRotationSnapshotBuffer(int32 Capacity)
+{
+	Snapshots.SetNum(FMath::Max(Capacity, 2));
+}
+
+void FRotationSnapshotBuffer::Add(float Time, float Yaw, float AimPitch)
+{
+	if (Count > 0)
+	{
+		FRotationSnapshot& Newest = Snapshots[(Head + Snapshots.Num() - 1) % Snapshots.Num()];
+		if (Time < Newest.Time) return;
+		// Several updates in one frame, keep the last
+		if (Time == Newest.Time)
+		{
+			Newest.Yaw = Yaw;
+			Newest.AimPitch = AimPitch;
+			return;
+		}
+	}
+
+	Snapshots[Head] = { Time, Yaw, AimPitch };
+	Head = (Head + 1) % Snapshots.Num();
+	Count = FMath::Min(Count + 1, Snapshots.Num());
+}
+
+bool FRotationSnapshotBuffer::Sample(float Time, float& OutYaw, float& OutAimPitch) const
+{
+	if (Count == 0) return false;
+
+	const FRotationSnapshot& Newest = GetByAge(0);
+	if (Time >= Newest.Time)
+	{
+		OutYaw = Newest.Yaw;
+		OutAimPitch = Newest.AimPitch;
+		return true;
+	}
+
+	for (int32 Age = 1; Age < Count; ++Age)
+	{
+		const FRotationSnapshot& Before = GetByAge(Age);
+		if (Before.Time > Time) continue;
+
+		const FRotationSnapshot& After = GetByAge(Age - 1);
+		const float Alpha = (Time - Before.Time) / (After.Time - Before.Time);
+		OutYaw = FRotator::NormalizeAxis(Before.Yaw + FRotator::NormalizeAxis(After.Yaw - Before.Yaw) * Alpha);
+		OutAimPitch = FMath::Lerp(Before.AimPitch, After.AimPitch, Alpha);
+		return true;
+	}
+
+	const FRotationSnapshot& Oldest = GetByAge(Count - 1);
+	OutYaw = Oldest.Yaw;
+	OutAimPitch = Oldest.AimPitch;
+	return true;
+}
+
+void FRotationSnapshotBuffer::Reset()
+{
+	Head = 0;
+	Count = 0;
+}
+
+const FRotationSnapshot& FRotationSnapshotBuffer::GetByAge(int32 Age) const
+{
+	return Snapshots[(Head + Snapshots.Num() - 1 - Age) % Snapshots.Num()];
+}
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Subsystems/AudioDispatchSubsystem.h"
+#include "Components/AudioComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "RPG/RPG.h"
+#include "Sound/SoundBase.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sounds Requested"), STAT_SoundsRequested, STATGROUP_RPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sounds Played"), STAT_SoundsPlayed, STATGROUP_RPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sounds Culled"), STAT_SoundsCulled, STATGROUP_RPG);
+
+bool UAudioDispatchSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if UE_SERVER
+	return false;
+#else
+	return Super::ShouldCreateSubsystem(Outer);
+#endif
+}
+
+bool UAudioDispatchSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UAudioDispatchSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAudioDispatchSubsystem, STATGROUP_Tickables);
+}
+
+void UAudioDispatchSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	Pools.SetNum(static_cast<int32>(ESoundCategory::ESC_MAX));
+}
+
+void UAudioDispatchSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	LastFrameStats = FrameStats;
+	FrameStats = FAudioDispatchFrameStats();
+	ReclaimFinishedVoices();
+}
+
+void UAudioDispatchSubsystem::ReclaimFinishedVoices()
+{
+	for (FAudioVoicePool& Pool : Pools)
+	{
+		for (int32 i = Pool.Playing.Num() - 1; i >= 0; --i)
+		{
+			UAudioComponent* Voice = Pool.Playing[i];
+			if (Voice == nullptr)
+			{
+				Pool.Playing.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			}
+			else if (!Voice->IsPlaying())
+			{
+				Pool.Playing.RemoveAtSwap(i, 1, EAllowShrinking::No);
+				Pool.Free.Add(Voice);
+			}
+		}
+	}
+}
+
+bool UAudioDispatchSubsystem::IsAudible(USoundBase* Sound, const FVector& Location) const
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController == nullptr) return false;
+
+	FVector ListenerLocation;
+	FVector FrontDir;
+	FVector RightDir;
+	PlayerController->GetAudioListenerPosition(ListenerLocation, FrontDir, RightDir);
+
+	const float MaxDistance = Sound->GetMaxDistance();
+	const float AudibleDistance = MaxDistance < WORLD_MAX ? MaxDistance : DefaultAudibleDistance;
+	return FVector::DistSquared(ListenerLocation, Location) <= FMath::Square(AudibleDistance);
+}
+
+UAudioComponent* UAudioDispatchSubsystem::AcquireVoice(ESoundCategory Category)
+{
+	FAudioVoicePool& Pool = Pools[static_cast<int32>(Category)];
+	if (Pool.Playing.Num() >= MaxVoices[static_cast<int32>(Category)]) return nullptr;
+
+	UAudioComponent* Voice = nullptr;
+	if (Pool.Free.Num() > 0)
+	{
+		Voice = Pool.Free.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		UWorld* World = GetWorld();
+		Voice = NewObject<UAudioComponent>(World->GetWorldSettings());
+		Voice->bAutoDestroy = false;
+		Voice->bAutoActivate = false;
+		Voice->bAllowSpatialization = true;
+		Voice->SetAbsolute(true, true, true);
+		Voice->RegisterComponentWithWorld(World);
+	}
+	Pool.Playing.Add(Voice);
+	return Voice;
+}
+
+bool UAudioDispatchSubsystem::PlaySound(USoundBase* Sound, const FVector& Location, ESoundCategory Category)
+{
+	if (Sound == nullptr || Category == ESoundCategory::ESC_MAX) return false;
+
+	UWorld* World = GetWorld();
+	if (World == nullptr || World->GetNetMode() == NM_DedicatedServer) return false;
+
+	++FrameStats.Requested;
+	INC_DWORD_STAT(STAT_SoundsRequested);
+
+	UAudioComponent* Voice = IsAudible(Sound, Location) ? AcquireVoice(Category) : nullptr;
+	if (Voice == nullptr)
+	{
+		++FrameStats.Culled;
+		INC_DWORD_STAT(STAT_SoundsCulled);
+		return false;
+	}
+
+	Voice->SetSound(Sound);
+	Voice->SetWorldLocation(Location);
+	Voice->Play();
+
+	++FrameStats.Played;
+	INC_DWORD_STAT(STAT_SoundsPlayed);
+	return true;
+}
@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Subsystems/CasingSubsystem.h"
+#include "Character/Subsystems/AudioDispatchSubsystem.h"
+#include "Character/Weapon/Casing.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "RPG/RPG.h"
+#include "Sound/SoundCue.h"
+
+DECLARE_CYCLE_STAT(TEXT("Casing Simulation"), STAT_CasingSimulation, STATGROUP_RPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Casings"), STAT_LiveCasings, STATGROUP_RPG);
+
+namespace
+{
+	// Horizontal speed kept when a casing hits the floor
+	constexpr float FloorFriction = 0.6f;
+	// Casings bouncing slower than this come to rest
+	constexpr float RestSpeed = 20.f;
+	// Tumble, in radians per second
+	constexpr float MaxSpinRate = 20.f;
+}
+
+bool UCasingSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if UE_SERVER
+	return false;
+#else
+	return Super::ShouldCreateSubsystem(Outer);
+#endif
+}
+
+bool UCasingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UCasingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCasingSubsystem, STATGROUP_Tickables);
+}
+
+int32 UCasingSubsystem::FindOrAddType(TSubclassOf<ACasing> CasingClass)
+{
+	int32 TypeIndex = CasingTypes.Find(CasingClass);
+	if (TypeIndex != INDEX_NONE || CasingTypes.Num() > MAX_uint8) return TypeIndex;
+
+	UStaticMesh* Mesh = CasingClass->GetDefaultObject<ACasing>()->GetCasingMesh();
+	UWorld* World = GetWorld();
+	if (Mesh == nullptr || World == nullptr) return INDEX_NONE;
+
+	if (RendererActor == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		RendererActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		if (RendererActor == nullptr) return INDEX_NONE;
+	}
+
+	UInstancedStaticMeshComponent* Renderer = NewObject<UInstancedStaticMeshComponent>(RendererActor);
+	Renderer->SetMobility(EComponentMobility::Movable);
+	Renderer->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Renderer->SetStaticMesh(Mesh);
+	if (RendererActor->GetRootComponent() == nullptr)
+	{
+		RendererActor->SetRootComponent(Renderer);
+	}
+	Renderer->RegisterComponent();
+
+	TypeIndex = CasingTypes.Add(CasingClass);
+	Renderers.Add(Renderer);
+	InstanceTransforms.AddDefaulted();
+	return TypeIndex;
+}
+
+void UCasingSubsystem::EjectCasing(TSubclassOf<ACasing> CasingClass, const FTransform& EjectTransform, const FVector& InheritedVelocity)
+{
+	UWorld* World = GetWorld();
+	if (CasingClass == nullptr || World == nullptr || World->GetNetMode() == NM_DedicatedServer) return;
+
+	const int32 TypeIndex = FindOrAddType(CasingClass);
+	if (TypeIndex == INDEX_NONE) return;
+
+	if (Positions.Num() >= MaxCasings)
+	{
+		FadeOldestCasing();
+	}
+
+	const ACasing* Defaults = CasingClass->GetDefaultObject<ACasing>();
+	const FVector Origin = EjectTransform.GetLocation();
+	const FVector Direction = FMath::VRandCone(EjectTransform.GetRotation().GetForwardVector(), FMath::DegreesToRadians(Defaults->GetEjectionSpread()));
+
+	// The only trace a casing ever does: the floor it will bounce on
+	FHitResult FloorHit;
+	const bool bFoundFloor = World->LineTraceSingleByObjectType(
+		FloorHit,
+		Origin,
+		Origin - FVector(0.f, 0.f, MaxFloorDistance),
+		FCollisionObjectQueryParams(ECC_WorldStatic));
+
+	Positions.Add(Origin);
+	Velocities.Add(InheritedVelocity + Direction * Defaults->GetEjectionSpeed());
+	Rotations.Add(EjectTransform.GetRotation());
+	AngularVelocities.Add(FMath::VRand() * FMath::FRandRange(0.f, MaxSpinRate));
+	FloorZ.Add(bFoundFloor ? FloorHit.ImpactPoint.Z : Origin.Z - MaxFloorDistance);
+	Lifetimes.Add(Defaults->GetLifetime() + FadeTime);
+	TypeIndices.Add(static_cast<uint8>(TypeIndex));
+	Bounced.Add(false);
+}
+
+void UCasingSubsystem::FadeOldestCasing()
+{
+	int32 Oldest = INDEX_NONE;
+	for (int32 i = 0; i < Lifetimes.Num(); ++i)
+	{
+		if (Oldest == INDEX_NONE || Lifetimes[i] < Lifetimes[Oldest])
+		{
+			Oldest = i;
+		}
+	}
+	if (Oldest == INDEX_NONE) return;
+
+	// Already fading, so nothing left to wait for
+	if (Lifetimes[Oldest] <= FadeTime)
+	{
+		RemoveCasing(Oldest);
+	}
+	else
+	{
+		Lifetimes[Oldest] = FadeTime;
+	}
+}
+
+void UCasingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SET_DWORD_STAT(STAT_LiveCasings, Positions.Num());
+	if (Positions.Num() == 0 && NumRendered == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_CasingSimulation);
+	Integrate(DeltaTime);
+
+	for (int32 i = Positions.Num() - 1; i >= 0; --i)
+	{
+		if (Lifetimes[i] <= 0.f)
+		{
+			RemoveCasing(i);
+		}
+	}
+	UpdateRenderers();
+}
+
+void UCasingSubsystem::Integrate(float DeltaTime)
+{
+	const int32 Num = Positions.Num();
+	const float GravityZ = GetWorld()->GetGravityZ();
+	int32 FirstBounce = INDEX_NONE;
+
+	FVector* RESTRICT Position = Positions.GetData();
+	FVector* RESTRICT Velocity = Velocities.GetData();
+	FQuat* RESTRICT Rotation = Rotations.GetData();
+	FVector* RESTRICT Spin = AngularVelocities.GetData();
+	const float* RESTRICT Floor = FloorZ.GetData();
+	float* RESTRICT Lifetime = Lifetimes.GetData();
+	for (int32 i = 0; i < Num; ++i)
+	{
+		Lifetime[i] -= DeltaTime;
+		if (Velocity[i].IsZero()) continue;
+
+		Velocity[i].Z += GravityZ * DeltaTime;
+		Position[i] += Velocity[i] * DeltaTime;
+
+		const float SpinRate = Spin[i].Size();
+		if (SpinRate > 0.f)
+		{
+			Rotation[i] = FQuat(Spin[i] / SpinRate, SpinRate * DeltaTime) * Rotation[i];
+		}
+
+		if (Position[i].Z <= Floor[i] && Velocity[i].Z < 0.f)
+		{
+			Position[i].Z = Floor[i];
+			const float Restitution = CasingTypes[TypeIndices[i]]->GetDefaultObject<ACasing>()->GetRestitution();
+			Velocity[i].Z *= -Restitution;
+			Velocity[i].X *= FloorFriction;
+			Velocity[i].Y *= FloorFriction;
+			Spin[i] *= 0.5f;
+			if (Velocity[i].Z < RestSpeed)
+			{
+				Velocity[i] = FVector::ZeroVector;
+				Spin[i] = FVector::ZeroVector;
+			}
+			if (!Bounced[i])
+			{
+				Bounced[i] = true;
+				FirstBounce = FirstBounce == INDEX_NONE ? i : FirstBounce;
+			}
+		}
+	}
+
+	// At most one shell sound per tick, and no more often than MinSoundInterval
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (FirstBounce != INDEX_NONE && Now - LastSoundTime >= MinSoundInterval)
+	{
+		USoundCue* ShellSound = CasingTypes[TypeIndices[FirstBounce]]->GetDefaultObject<ACasing>()->GetShellSound();
+		UAudioDispatchSubsystem* AudioDispatch = GetWorld()->GetSubsystem<UAudioDispatchSubsystem>();
+		if (ShellSound && AudioDispatch)
+		{
+			AudioDispatch->PlaySound(ShellSound, Positions[FirstBounce], ESoundCategory::ESC_Shell);
+			LastSoundTime = Now;
+		}
+	}
+}
+
+void UCasingSubsystem::UpdateRenderers()
+{
+	for (TArray<FTransform>& Transforms : InstanceTransforms)
+	{
+		Transforms.Reset();
+	}
+	for (int32 i = 0; i < Positions.Num(); ++i)
+	{
+		const float Scale = FMath::Clamp(Lifetimes[i] / FadeTime, 0.f, 1.f);
+		InstanceTransforms[TypeIndices[i]].Add(FTransform(Rotations[i], Positions[i], FVector(Scale)));
+	}
+
+	for (int32 Type = 0; Type < Renderers.Num(); ++Type)
+	{
+		UInstancedStaticMeshComponent* Renderer = Renderers[Type];
+		const TArray<FTransform>& Transforms = InstanceTransforms[Type];
+		if (Renderer == nullptr) continue;
+
+		// Instances are interchangeable, so only the count changes and the transforms are rewritten
+		const int32 Current = Renderer->GetInstanceCount();
+		if (Transforms.Num() > Current)
+		{
+			Renderer->AddInstances(TArray<FTransform>(Transforms.GetData() + Current, Transforms.Num() - Current), false, true);
+		}
+		else if (Transforms.Num() < Current)
+		{
+			TArray<int32> Removed;
+			for (int32 Index = Current - 1; Index >= Transforms.Num(); --Index)
+			{
+				Removed.Add(Index);
+			}
+			Renderer->RemoveInstances(Removed);
+		}
+		if (Transforms.Num() > 0)
+		{
+			Renderer->BatchUpdateInstancesTransforms(0, Transforms, true, true);
+		}
+	}
+	NumRendered = Positions.Num();
+}
+
+void UCasingSubsystem::RemoveCasing(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Rotations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	AngularVelocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	FloorZ.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Lifetimes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TypeIndices.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Bounced.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
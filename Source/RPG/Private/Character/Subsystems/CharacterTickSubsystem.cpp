@@ -0,0 +1,302 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Subsystems/CharacterTickSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Character/MainCharacter.h"
+#include "Character/CharacterComponents/CombatComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "RPG/RPG.h"
+
+DECLARE_CYCLE_STAT(TEXT("Character Batch Tick"), STAT_CharacterBatchTick, STATGROUP_RPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Batched Characters"), STAT_BatchedCharacters, STATGROUP_RPG);
+
+bool UCharacterTickSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void FCharacterBatchTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->Tick(DeltaTime);
+	}
+}
+
+FString FCharacterBatchTickFunction::DiagnosticMessage()
+{
+	return TEXT("UCharacterTickSubsystem::BatchTick");
+}
+
+void UCharacterTickSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	BatchTickFunction.Target = this;
+	BatchTickFunction.bCanEverTick = true;
+	BatchTickFunction.TickGroup = TG_PrePhysics;
+	BatchTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UCharacterTickSubsystem::Deinitialize()
+{
+	if (BatchTickFunction.IsTickFunctionRegistered())
+	{
+		BatchTickFunction.UnRegisterTickFunction();
+	}
+	BatchTickFunction.Target = nullptr;
+	Super::Deinitialize();
+}
+
+void UCharacterTickSubsystem::RegisterCharacter(AMainCharacter* Character)
+{
+	if (Character == nullptr || Characters.Contains(Character)) return;
+
+	// Movement has settled velocity and rotation before the batch reads them, and the mesh
+	// animates with this frame's aim instead of last frame's
+	BatchTickFunction.AddPrerequisite(Character->GetCharacterMovement(), Character->GetCharacterMovement()->PrimaryComponentTick);
+	Character->GetMesh()->PrimaryComponentTick.AddPrerequisite(this, BatchTickFunction);
+
+	Characters.Add(Character);
+	AO_Yaws.Add(0.f);
+	InterpAO_Yaws.Add(0.f);
+	AO_Pitches.Add(0.f);
+	StartingAimYaws.Add(Character->GetBaseAimRotation().Yaw);
+	TurningInPlace.Add(ETurningInPlace::ETIP_NotTurning);
+	RotateRootBone.Add(false);
+	LastProxyYaws.Add(Character->GetActorRotation().Yaw);
+}
+
+void UCharacterTickSubsystem::UnregisterCharacter(AMainCharacter* Character)
+{
+	// Cleared rather than removed, a character can go away in the middle of the batch
+	const int32 Index = Characters.Find(Character);
+	if (Index != INDEX_NONE)
+	{
+		Characters[Index] = nullptr;
+		BatchTickFunction.RemovePrerequisite(Character->GetCharacterMovement(), Character->GetCharacterMovement()->PrimaryComponentTick);
+		Character->GetMesh()->PrimaryComponentTick.RemovePrerequisite(this, BatchTickFunction);
+	}
+}
+
+void UCharacterTickSubsystem::RemoveStaleCharacters()
+{
+	for (int32 i = Characters.Num() - 1; i >= 0; --i)
+	{
+		if (Characters[i] != nullptr) continue;
+
+		Characters.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		AO_Yaws.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		InterpAO_Yaws.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		AO_Pitches.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		StartingAimYaws.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		TurningInPlace.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		RotateRootBone.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		LastProxyYaws.RemoveAtSwap(i, 1, EAllowShrinking::No);
+	}
+}
+
+void UCharacterTickSubsystem::Tick(float DeltaTime)
+{
+	RemoveStaleCharacters();
+	const int32 Num = Characters.Num();
+	SET_DWORD_STAT(STAT_BatchedCharacters, Num);
+	if (Num == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_CharacterBatchTick);
+
+	Gather();
+	ParallelFor(Num, [this, DeltaTime](int32 i)
+	{
+		UpdateAim(i, DeltaTime);
+	}, Num < MinParallelCharacters ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	Scatter();
+
+	// Work with side effects stays on the game thread
+	for (int32 i = 0; i < Num; ++i)
+	{
+		if (Characters[i])
+		{
+			Characters[i]->BatchedTick(DeltaTime);
+		}
+	}
+}
+
+void UCharacterTickSubsystem::Gather()
+{
+	const int32 Num = Characters.Num();
+	AimModes.SetNum(Num, EAllowShrinking::No);
+	Speeds.SetNum(Num, EAllowShrinking::No);
+	InAir.SetNum(Num, EAllowShrinking::No);
+	AimYaws.SetNum(Num, EAllowShrinking::No);
+	AimPitches.SetNum(Num, EAllowShrinking::No);
+	Armed.SetNum(Num, EAllowShrinking::No);
+	ProxyYaws.SetNum(Num, EAllowShrinking::No);
+	ProxyTurnRates.SetNum(Num, EAllowShrinking::No);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	for (int32 i = 0; i < Num; ++i)
+	{
+		AMainCharacter* Character = Characters[i];
+		if (Character == nullptr)
+		{
+			AimModes[i] = ECharacterAimMode::Unarmed;
+			continue;
+		}
+
+		if (Character->bDisableGameplay)
+		{
+			AimModes[i] = ECharacterAimMode::Disabled;
+		}
+		else if (Character->GetLocalRole() > ROLE_SimulatedProxy && Character->IsLocallyControlled())
+		{
+			const bool bArmed = Character->CombatComponent == nullptr || Character->CombatComponent->EquippedWeapon;
+			AimModes[i] = bArmed ? ECharacterAimMode::Local : ECharacterAimMode::Unarmed;
+		}
+		else
+		{
+			AimModes[i] = ECharacterAimMode::Remote;
+		}
+
+		const FVector Velocity = Character->GetVelocity();
+		Speeds[i] = Velocity.Size2D();
+		InAir[i] = Character->GetCharacterMovement()->IsFalling();
+
+		const FRotator AimRotation = Character->GetBaseAimRotation();
+		AimYaws[i] = AimRotation.Yaw;
+		AimPitches[i] = FRotator::NormalizeAxis(AimRotation.Pitch);
+
+		if (AimModes[i] == ECharacterAimMode::Remote)
+		{
+			Armed[i] = Character->CombatComponent && Character->CombatComponent->EquippedWeapon;
+			ProxyTurnRates[i] = Character->ProxyTurnRate;
+			ProxyYaws[i] = Character->GetActorRotation().Yaw;
+
+			// The server moves remote players itself and uses their live rotation, only simulated
+			// proxies play back the snapshots from OnRep_ReplicatedMovement
+			if (Character->GetLocalRole() == ROLE_SimulatedProxy)
+			{
+				// Aim pitch replicates apart from movement, so a proxy standing still while looking up or
+				// down gets no OnRep_ReplicatedMovement. Record it here when it changes
+				const FRotationSnapshot* Newest = Character->ProxySnapshots.GetNewest();
+				if (Newest == nullptr || Newest->AimPitch != AimPitches[i])
+				{
+					Character->ProxySnapshots.Add(Now, Character->GetReplicatedMovement().Rotation.Yaw, AimPitches[i]);
+				}
+				Character->ProxySnapshots.Sample(Now - Character->ProxyInterpDelay, ProxyYaws[i], AimPitches[i]);
+			}
+		}
+	}
+}
+
+void UCharacterTickSubsystem::UpdateAim(int32 Index, float DeltaTime)
+{
+	switch (AimModes[Index])
+	{
+	case ECharacterAimMode::Disabled:
+		TurningInPlace[Index] = ETurningInPlace::ETIP_NotTurning;
+		break;
+	case ECharacterAimMode::Local:
+		if (Speeds[Index] == 0.f && !InAir[Index])
+		{
+			RotateRootBone[Index] = true;
+			AO_Yaws[Index] = FRotator::NormalizeAxis(AimYaws[Index] - StartingAimYaws[Index]);
+			if (TurningInPlace[Index] == ETurningInPlace::ETIP_NotTurning)
+			{
+				InterpAO_Yaws[Index] = AO_Yaws[Index];
+			}
+			TurnInPlace(Index, DeltaTime);
+		}
+		else
+		{
+			RotateRootBone[Index] = false;
+			StartingAimYaws[Index] = AimYaws[Index];
+			AO_Yaws[Index] = 0.f;
+			TurningInPlace[Index] = ETurningInPlace::ETIP_NotTurning;
+		}
+		AO_Pitches[Index] = AimPitches[Index];
+		break;
+	case ECharacterAimMode::Remote:
+		AO_Pitches[Index] = AimPitches[Index];
+		ProxyTurnInPlace(Index, DeltaTime);
+		break;
+	default:
+		break;
+	}
+}
+
+void UCharacterTickSubsystem::ProxyTurnInPlace(int32 Index, float DeltaTime)
+{
+	const float YawRate = DeltaTime > 0.f ? FRotator::NormalizeAxis(ProxyYaws[Index] - LastProxyYaws[Index]) / DeltaTime : 0.f;
+	LastProxyYaws[Index] = ProxyYaws[Index];
+
+	RotateRootBone[Index] = false;
+	if (!Armed[Index] || Speeds[Index] > 0.f)
+	{
+		TurningInPlace[Index] = ETurningInPlace::ETIP_NotTurning;
+	}
+	else if (FMath::Abs(YawRate) > ProxyTurnRates[Index])
+	{
+		TurningInPlace[Index] = YawRate > 0.f ? ETurningInPlace::ETIP_Right : ETurningInPlace::ETIP_Left;
+	}
+	// Keeps turning until the rate has clearly dropped, so a slow turn doesn't flicker
+	else if (FMath::Abs(YawRate) < ProxyTurnRates[Index] * 0.5f)
+	{
+		TurningInPlace[Index] = ETurningInPlace::ETIP_NotTurning;
+	}
+}
+
+void UCharacterTickSubsystem::TurnInPlace(int32 Index, float DeltaTime)
+{
+	if (AO_Yaws[Index] > 90.f)
+	{
+		TurningInPlace[Index] = ETurningInPlace::ETIP_Right;
+	}
+	else if (AO_Yaws[Index] < -90.f)
+	{
+		TurningInPlace[Index] = ETurningInPlace::ETIP_Left;
+	}
+	if (TurningInPlace[Index] != ETurningInPlace::ETIP_NotTurning)
+	{
+		InterpAO_Yaws[Index] = FMath::FInterpTo(InterpAO_Yaws[Index], 0.f, DeltaTime, 2.f);
+		AO_Yaws[Index] = InterpAO_Yaws[Index];
+		if (FMath::Abs(AO_Yaws[Index]) < 15.f)
+		{
+			TurningInPlace[Index] = ETurningInPlace::ETIP_NotTurning;
+			StartingAimYaws[Index] = AimYaws[Index];
+		}
+	}
+}
+
+void UCharacterTickSubsystem::Scatter()
+{
+	for (int32 i = 0; i < Characters.Num(); ++i)
+	{
+		AMainCharacter* Character = Characters[i];
+		if (Character == nullptr) continue;
+
+		switch (AimModes[i])
+		{
+		case ECharacterAimMode::Disabled:
+			Character->bUseControllerRotationYaw = false;
+			Character->TurningInPlace = ETurningInPlace::ETIP_NotTurning;
+			break;
+		case ECharacterAimMode::Local:
+			Character->bUseControllerRotationYaw = true;
+			Character->AO_Yaw = AO_Yaws[i];
+			Character->AO_Pitch = AO_Pitches[i];
+			Character->TurningInPlace = TurningInPlace[i];
+			Character->bRotateRootBone = RotateRootBone[i];
+			break;
+		case ECharacterAimMode::Remote:
+			Character->AO_Pitch = AO_Pitches[i];
+			Character->TurningInPlace = TurningInPlace[i];
+			Character->bRotateRootBone = RotateRootBone[i];
+			break;
+		default:
+			break;
+		}
+	}
+}
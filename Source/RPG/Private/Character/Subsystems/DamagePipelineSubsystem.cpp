@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Subsystems/DamagePipelineSubsystem.h"
+#include "Character/MainCharacter.h"
+#include "Kismet/GameplayStatics.h"
+#include "RPG/RPG.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Hits Processed"), STAT_DamageHitsProcessed, STATGROUP_RPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Events Applied"), STAT_DamageEventsApplied, STATGROUP_RPG);
+
+bool UDamagePipelineSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDamagePipelineSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UDamagePipelineSubsystem::OnWorldPostActorTick);
+}
+
+void UDamagePipelineSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	PendingHits.Empty();
+
+	Super::Deinitialize();
+}
+
+void UDamagePipelineSubsystem::QueueDamage(AActor* Victim, float Damage, AController* InstigatorController, AActor* DamageCauser)
+{
+	if (Victim == nullptr || Damage <= 0.f || GetWorld()->GetNetMode() == NM_Client) return;
+
+	FDamageHit& Hit = PendingHits.AddDefaulted_GetRef();
+	Hit.Victim = Victim;
+	Hit.InstigatorController = InstigatorController;
+	Hit.DamageCauser = DamageCauser;
+	Hit.Damage = Damage;
+}
+
+void UDamagePipelineSubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (World != GetWorld()) return;
+
+	FlushDamage();
+}
+
+void UDamagePipelineSubsystem::FlushDamage()
+{
+	HitsLastFrame = PendingHits.Num();
+	DamageEventsLastFrame = 0;
+	SET_DWORD_STAT(STAT_DamageHitsProcessed, HitsLastFrame);
+	SET_DWORD_STAT(STAT_DamageEventsApplied, 0);
+	if (PendingHits.Num() == 0) return;
+
+	VictimDamage.Reset();
+	VictimIndices.Reset();
+	for (const FDamageHit& Hit : PendingHits)
+	{
+		AActor* Victim = Hit.Victim.Get();
+		if (Victim == nullptr) continue;
+
+		int32& Index = VictimIndices.FindOrAdd(Victim, INDEX_NONE);
+		if (Index == INDEX_NONE)
+		{
+			Index = VictimDamage.AddDefaulted();
+			VictimDamage[Index].Victim = Victim;
+		}
+
+		FVictimDamage& Entry = VictimDamage[Index];
+		Entry.Damage += Hit.Damage;
+		if (!Entry.bLethal)
+		{
+			Entry.InstigatorController = Hit.InstigatorController;
+			Entry.DamageCauser = Hit.DamageCauser;
+
+			AMainCharacter* Character = Cast<AMainCharacter>(Victim);
+			Entry.bLethal = Character && Entry.Damage >= Character->GetHealth();
+		}
+	}
+	PendingHits.Reset();
+
+	for (const FVictimDamage& Entry : VictimDamage)
+	{
+		AMainCharacter* Character = Cast<AMainCharacter>(Entry.Victim);
+		if (Character)
+		{
+			Character->ApplyFrameDamage(Entry.Damage, Entry.InstigatorController.Get(), Entry.DamageCauser.Get());
+		}
+		else
+		{
+			// Anything that is not a character keeps the engine damage events
+			UGameplayStatics::ApplyDamage(
+				Entry.Victim,
+				Entry.Damage,
+				Entry.InstigatorController.Get(),
+				Entry.DamageCauser.Get(),
+				UDamageType::StaticClass()
+			);
+		}
+	}
+
+	DamageEventsLastFrame = VictimDamage.Num();
+	SET_DWORD_STAT(STAT_DamageEventsApplied, DamageEventsLastFrame);
+}
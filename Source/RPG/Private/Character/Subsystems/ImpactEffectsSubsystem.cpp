@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Subsystems/ImpactEffectsSubsystem.h"
+#include "Character/Subsystems/AudioDispatchSubsystem.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "RPG/RPG.h"
+#include "Sound/SoundCue.h"
+
+DECLARE_CYCLE_STAT(TEXT("Impact Effects"), STAT_ImpactEffects, STATGROUP_RPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Impacts Queued"), STAT_ImpactsQueued, STATGROUP_RPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Impacts Merged"), STAT_ImpactsMerged, STATGROUP_RPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Impacts Culled"), STAT_ImpactsCulled, STATGROUP_RPG);
+
+bool UImpactEffectsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if UE_SERVER
+	return false;
+#else
+	return Super::ShouldCreateSubsystem(Outer);
+#endif
+}
+
+bool UImpactEffectsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UImpactEffectsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UImpactEffectsSubsystem, STATGROUP_Tickables);
+}
+
+EPhysicalSurface UImpactEffectsSubsystem::GetSurfaceType(const FHitResult& Hit)
+{
+	return Hit.PhysMaterial.IsValid() ? Hit.PhysMaterial->SurfaceType.GetValue() : SurfaceType_Default;
+}
+
+void UImpactEffectsSubsystem::QueueImpact(const FImpactEffect& Effect, const FVector& Location, const FRotator& Rotation)
+{
+	if (!Effect.IsSet() || GetWorld() == nullptr || GetWorld()->GetNetMode() == NM_DedicatedServer) return;
+
+	PendingImpacts.Add({ Effect, Location, Rotation });
+	INC_DWORD_STAT(STAT_ImpactsQueued);
+}
+
+void UImpactEffectsSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingImpacts.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_ImpactEffects);
+
+	// Everything is culled against the local player's view
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const APlayerCameraManager* CameraManager = PlayerController ? PlayerController->PlayerCameraManager : nullptr;
+	if (CameraManager == nullptr)
+	{
+		PendingImpacts.Reset();
+		return;
+	}
+	const FVector ViewLocation = CameraManager->GetCameraLocation();
+	const FVector ViewDirection = CameraManager->GetCameraRotation().Vector();
+	const float HalfAngle = FMath::Min(CameraManager->GetFOVAngle() * 0.5f + ViewConeMargin, 180.f);
+	const float MinViewDot = FMath::Cos(FMath::DegreesToRadians(HalfAngle));
+
+	UAudioDispatchSubsystem* AudioDispatch = GetWorld()->GetSubsystem<UAudioDispatchSubsystem>();
+	int32 ParticlesLeft = MaxParticlesPerFrame;
+	TArray<int32, TInlineAllocator<32>> Played;
+	for (int32 i = 0; i < PendingImpacts.Num(); ++i)
+	{
+		const FPendingImpact& Impact = PendingImpacts[i];
+
+		const bool bMerged = Played.ContainsByPredicate([this, &Impact](int32 Other)
+		{
+			const FPendingImpact& OtherImpact = PendingImpacts[Other];
+			return OtherImpact.Effect.Particles == Impact.Effect.Particles &&
+				OtherImpact.Effect.Sound == Impact.Effect.Sound &&
+				FVector::DistSquared(OtherImpact.Location, Impact.Location) < FMath::Square(MergeDistance);
+		});
+		if (bMerged)
+		{
+			INC_DWORD_STAT(STAT_ImpactsMerged);
+			continue;
+		}
+		Played.Add(i);
+
+		const FVector ToImpact = Impact.Location - ViewLocation;
+		const float DistanceSquared = ToImpact.SizeSquared();
+		if (Impact.Effect.Particles)
+		{
+			const bool bVisible = DistanceSquared <= FMath::Square(MaxParticleDistance) &&
+				(ToImpact.GetSafeNormal() | ViewDirection) >= MinViewDot;
+			if (bVisible && ParticlesLeft > 0)
+			{
+				SpawnParticles(Impact.Effect.Particles, Impact.Location, Impact.Rotation);
+				--ParticlesLeft;
+			}
+			else
+			{
+				INC_DWORD_STAT(STAT_ImpactsCulled);
+			}
+		}
+		// Sounds are heard off-screen, distance and voice limits are up to the audio dispatcher
+		if (Impact.Effect.Sound && AudioDispatch)
+		{
+			AudioDispatch->PlaySound(Impact.Effect.Sound, Impact.Location, ESoundCategory::ESC_Impact);
+		}
+	}
+	PendingImpacts.Reset();
+}
+
+void UImpactEffectsSubsystem::SpawnParticles(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+	FImpactParticlePool& Pool = ParticlePools.FindOrAdd(Template);
+
+	UParticleSystemComponent* Component = nullptr;
+	if (Pool.Free.Num() > 0)
+	{
+		Component = Pool.Free.Pop(EAllowShrinking::No);
+	}
+	else if (Pool.Components.Num() < MaxPooledPerTemplate)
+	{
+		UWorld* World = GetWorld();
+		Component = NewObject<UParticleSystemComponent>(World->GetWorldSettings());
+		Component->bAutoDestroy = false;
+		Component->bAutoActivate = false;
+		Component->SetAbsolute(true, true, true);
+		Component->SetTemplate(Template);
+		Component->OnSystemFinished.AddDynamic(this, &UImpactEffectsSubsystem::OnParticlesFinished);
+		Component->RegisterComponentWithWorld(World);
+		Pool.Components.Add(Component);
+	}
+	// Every component of this template is still playing
+	if (Component == nullptr) return;
+
+	Component->SetWorldLocationAndRotation(Location, Rotation);
+	Component->ActivateSystem(true);
+}
+
+void UImpactEffectsSubsystem::OnParticlesFinished(UParticleSystemComponent* Component)
+{
+	FImpactParticlePool* Pool = Component ? ParticlePools.Find(Component->Template) : nullptr;
+	if (Pool)
+	{
+		Pool->Free.AddUnique(Component);
+	}
+}
@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Subsystems/LagCompensationSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Character/MainCharacter.h"
+#include "Character/CharacterComponents/LagCompensationComponent.h"
+#include "Character/Subsystems/DamagePipelineSubsystem.h"
+#include "RPG/RPG.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Shots Validated"), STAT_ShotsValidated, STATGROUP_RPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Shots Rejected"), STAT_ShotsRejected, STATGROUP_RPG);
+
+bool ULagCompensationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId ULagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+void ULagCompensationSubsystem::RegisterComponent(ULagCompensationComponent* Component)
+{
+	Components.AddUnique(Component);
+}
+
+void ULagCompensationSubsystem::UnregisterComponent(ULagCompensationComponent* Component)
+{
+	Components.RemoveSingleSwap(Component);
+}
+
+void ULagCompensationSubsystem::QueueShot(const FRewindShot& Shot)
+{
+	PendingShots.Add(Shot);
+}
+
+void ULagCompensationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* World = GetWorld();
+	if (World == nullptr || World->GetNetMode() == NM_Client) return;
+
+	const float ServerTime = World->GetTimeSeconds();
+	RecordSnapshots(ServerTime);
+	ResolveShots(ServerTime);
+}
+
+void ULagCompensationSubsystem::RecordSnapshots(float ServerTime)
+{
+	for (ULagCompensationComponent* Component : Components)
+	{
+		if (Component)
+		{
+			Component->RecordSnapshot(ServerTime);
+		}
+	}
+}
+
+void ULagCompensationSubsystem::ResolveShots(float ServerTime)
+{
+	if (PendingShots.Num() == 0) return;
+
+	// Weak pointers are resolved here, the workers only see raw pointers
+	ShotChecks.Reset();
+	ShotChecks.SetNum(PendingShots.Num());
+	for (int32 ShotIndex = 0; ShotIndex < PendingShots.Num(); ++ShotIndex)
+	{
+		const FRewindShot& Shot = PendingShots[ShotIndex];
+		if (!Shot.Shooter.IsValid() || !Shot.DamageCauser.IsValid()) continue;
+
+		FShotCheck& Check = ShotChecks[ShotIndex];
+		Check.Shooter = Shot.Shooter.Get();
+		Check.DamageCauser = Shot.DamageCauser.Get();
+		Check.ShooterLocation = Check.Shooter->GetActorLocation();
+		Check.EyeHeight = Check.Shooter->BaseEyeHeight;
+		const AMainCharacter* ShooterCharacter = Cast<AMainCharacter>(Check.Shooter);
+		Check.ShooterHistory = ShooterCharacter ? ShooterCharacter->GetLagCompensation() : nullptr;
+	}
+
+	ParallelFor(ShotChecks.Num(), [this, ServerTime](int32 i)
+	{
+		ValidateShot(i, ServerTime);
+	}, ShotChecks.Num() < MinParallelRays ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	Rays.Reset();
+	int32 NumRejected = 0;
+	for (int32 ShotIndex = 0; ShotIndex < PendingShots.Num(); ++ShotIndex)
+	{
+		if (!ShotChecks[ShotIndex].bValid)
+		{
+			NumRejected++;
+			continue;
+		}
+
+		for (const FVector& End : PendingShots[ShotIndex].Ends)
+		{
+			FRewindRay& Ray = Rays.AddDefaulted_GetRef();
+			Ray.ShotIndex = ShotIndex;
+			Ray.End = End;
+		}
+	}
+	INC_DWORD_STAT_BY(STAT_ShotsValidated, PendingShots.Num() - NumRejected);
+	INC_DWORD_STAT_BY(STAT_ShotsRejected, NumRejected);
+	UE_CLOG(NumRejected > 0, LogRPG, Verbose, TEXT("Rejected %d of %d shots this frame"), NumRejected, PendingShots.Num());
+
+	FCollisionObjectQueryParams WorldObjects;
+	WorldObjects.AddObjectTypesToQuery(ECC_WorldStatic);
+	WorldObjects.AddObjectTypesToQuery(ECC_WorldDynamic);
+
+	ParallelFor(Rays.Num(), [this, ServerTime, &WorldObjects](int32 i)
+	{
+		TraceRay(Rays[i], ServerTime, WorldObjects);
+	}, Rays.Num() < MinParallelRays ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	// Rays are in queue order, so damage lands in the same order the shots arrived
+	ApplyRayDamage();
+	PendingShots.Reset();
+}
+
+void ULagCompensationSubsystem::ValidateShot(int32 ShotIndex, float ServerTime)
+{
+	const FRewindShot& Shot = PendingShots[ShotIndex];
+	FShotCheck& Check = ShotChecks[ShotIndex];
+	if (Check.Shooter == nullptr) return;
+
+	const float HitTime = FMath::Clamp(Shot.HitTime, ServerTime - MaxRewindTime, ServerTime);
+	FVector ShooterLocation = Check.ShooterLocation;
+	if (Check.ShooterHistory)
+	{
+		Check.ShooterHistory->GetRewoundLocation(HitTime, ShooterLocation);
+	}
+
+	// The muzzle has to be somewhere the shooter could have been holding the weapon...
+	if (FVector::DistSquared(Shot.Start, ShooterLocation) > FMath::Square(MaxMuzzleOffset)) return;
+
+	// ...and not pushed through a wall from there
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShotMuzzleCheck), false);
+	QueryParams.AddIgnoredActor(Check.Shooter);
+	QueryParams.AddIgnoredActor(Check.DamageCauser);
+	const FVector EyeLocation = ShooterLocation + FVector(0.f, 0.f, Check.EyeHeight);
+	if (GetWorld()->LineTraceTestByObjectType(EyeLocation, Shot.Start, FCollisionObjectQueryParams(ECC_WorldStatic), QueryParams)) return;
+
+	Check.bValid = true;
+}
+
+void ULagCompensationSubsystem::TraceRay(FRewindRay& Ray, float ServerTime, const FCollisionObjectQueryParams& WorldObjects) const
+{
+	const FRewindShot& Shot = PendingShots[Ray.ShotIndex];
+	const FShotCheck& Check = ShotChecks[Ray.ShotIndex];
+	const float HitTime = FMath::Clamp(Shot.HitTime, ServerTime - MaxRewindTime, ServerTime);
+
+	// Line of sight. Level geometry is static enough to test in the present
+	float BlockingTime = 1.f;
+	FHitResult WorldHit;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(RewindShot), false);
+	QueryParams.AddIgnoredActor(Check.Shooter);
+	QueryParams.AddIgnoredActor(Check.DamageCauser);
+	if (GetWorld()->LineTraceSingleByObjectType(WorldHit, Shot.Start, Ray.End, WorldObjects, QueryParams))
+	{
+		BlockingTime = WorldHit.Time;
+	}
+
+	Ray.HitTime = BlockingTime;
+	for (ULagCompensationComponent* Component : Components)
+	{
+		AMainCharacter* Candidate = Component ? Cast<AMainCharacter>(Component->GetOwner()) : nullptr;
+		if (Candidate == nullptr || Candidate == Check.Shooter || Candidate->IsElimmed()) continue;
+
+		float CandidateTime;
+		FVector CandidateLocation;
+		EHitRegion CandidateRegion;
+		if (Component->IntersectRewound(HitTime, Shot.Start, Ray.End, CandidateTime, CandidateLocation, CandidateRegion)
+			&& CandidateTime < Ray.HitTime)
+		{
+			Ray.Victim = Candidate;
+			Ray.HitTime = CandidateTime;
+			Ray.HitLocation = CandidateLocation;
+			Ray.DamageMultiplier = Component->GetDamageMultiplier(CandidateRegion);
+		}
+	}
+}
+
+void ULagCompensationSubsystem::ApplyRayDamage()
+{
+	// Pellets are queued one by one, the damage pipeline sums them per victim
+	UDamagePipelineSubsystem* DamagePipeline = GetWorld()->GetSubsystem<UDamagePipelineSubsystem>();
+	if (DamagePipeline == nullptr) return;
+
+	for (const FRewindRay& Ray : Rays)
+	{
+		if (Ray.Victim == nullptr) continue;
+
+		const FRewindShot& Shot = PendingShots[Ray.ShotIndex];
+		DamagePipeline->QueueDamage(
+			Ray.Victim,
+			Shot.Damage * Ray.DamageMultiplier,
+			Shot.InstigatorController.Get(),
+			Shot.DamageCauser.Get()
+		);
+	}
+}
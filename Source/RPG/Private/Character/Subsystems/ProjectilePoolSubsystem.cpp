@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Subsystems/ProjectilePoolSubsystem.h"
+#include "Character/Weapon/Projectile.h"
+#include "RPG/RPG.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Pool Requests"), STAT_ProjectilePoolRequests, STATGROUP_RPG);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Pool Hits"), STAT_ProjectilePoolHits, STATGROUP_RPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectiles Active"), STAT_ProjectilesActive, STATGROUP_RPG);
+
+bool UProjectilePoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UProjectilePoolSubsystem::Deinitialize()
+{
+	LogPoolStats();
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+void UProjectilePoolSubsystem::Prewarm(TSubclassOf<AProjectile> ProjectileClass, int32 Count)
+{
+	if (ProjectileClass == nullptr) return;
+
+	FProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+	while (Pool.Free.Num() + Pool.NumActive < Count)
+	{
+		AProjectile* Projectile = SpawnPooledProjectile(ProjectileClass);
+		if (Projectile == nullptr) return;
+		Pool.Free.Add(Projectile);
+	}
+}
+
+AProjectile* UProjectilePoolSubsystem::AcquireProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Location,
+                                                         const FRotator& Rotation, AActor* Owner, APawn* Instigator)
+{
+	if (ProjectileClass == nullptr) return nullptr;
+
+	FProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+	Pool.Requests++;
+	INC_DWORD_STAT(STAT_ProjectilePoolRequests);
+
+	AProjectile* Projectile = nullptr;
+	while (Projectile == nullptr && Pool.Free.Num() > 0)
+	{
+		Projectile = Pool.Free.Pop(EAllowShrinking::No);
+		if (!IsValid(Projectile))
+		{
+			Projectile = nullptr;
+		}
+	}
+
+	if (Projectile)
+	{
+		Pool.Hits++;
+		INC_DWORD_STAT(STAT_ProjectilePoolHits);
+	}
+	else
+	{
+		Projectile = SpawnPooledProjectile(ProjectileClass);
+		if (Projectile == nullptr) return nullptr;
+	}
+
+	Pool.NumActive++;
+	Pool.PeakActive = FMath::Max(Pool.PeakActive, Pool.NumActive);
+	INC_DWORD_STAT(STAT_ProjectilesActive);
+
+	Projectile->SetOwner(Owner);
+	Projectile->SetInstigator(Instigator);
+	Projectile->LaunchFromPool(Location, Rotation.Vector());
+	return Projectile;
+}
+
+void UProjectilePoolSubsystem::ReleaseProjectile(AProjectile* Projectile)
+{
+	if (Projectile == nullptr) return;
+
+	FProjectilePool* Pool = Pools.Find(Projectile->GetClass());
+	if (Pool == nullptr) return;
+
+	Pool->NumActive = FMath::Max(Pool->NumActive - 1, 0);
+	Pool->Free.Add(Projectile);
+	DEC_DWORD_STAT(STAT_ProjectilesActive);
+}
+
+AProjectile* UProjectilePoolSubsystem::SpawnPooledProjectile(TSubclassOf<AProjectile> ProjectileClass)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) return nullptr;
+
+	AProjectile* Projectile = World->SpawnActorDeferred<AProjectile>(
+		ProjectileClass,
+		FTransform::Identity,
+		nullptr,
+		nullptr,
+		ESpawnActorCollisionHandlingMethod::AlwaysSpawn
+	);
+	if (Projectile)
+	{
+		Projectile->bPooled = true;
+		Projectile->FinishSpawning(FTransform::Identity);
+	}
+	return Projectile;
+}
+
+float UProjectilePoolSubsystem::GetHitRate(TSubclassOf<AProjectile> ProjectileClass) const
+{
+	const FProjectilePool* Pool = Pools.Find(ProjectileClass);
+	if (Pool == nullptr || Pool->Requests == 0) return 0.f;
+	return static_cast<float>(Pool->Hits) / Pool->Requests;
+}
+
+int32 UProjectilePoolSubsystem::GetPeakActive(TSubclassOf<AProjectile> ProjectileClass) const
+{
+	const FProjectilePool* Pool = Pools.Find(ProjectileClass);
+	return Pool ? Pool->PeakActive : 0;
+}
+
+void UProjectilePoolSubsystem::LogPoolStats() const
+{
+	for (const TPair<UClass*, FProjectilePool>& Pair : Pools)
+	{
+		const FProjectilePool& Pool = Pair.Value;
+		UE_LOG(LogRPG, Log, TEXT("Projectile pool %s: %d requests, %.1f%% hit rate, peak %d active, %d pooled"),
+		       *GetNameSafe(Pair.Key),
+		       Pool.Requests,
+		       Pool.Requests > 0 ? 100.f * Pool.Hits / Pool.Requests : 0.f,
+		       Pool.PeakActive,
+		       Pool.Free.Num() + Pool.NumActive);
+	}
+}
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Subsystems/ProjectileSimulationSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Character/Subsystems/DamagePipelineSubsystem.h"
+#include "Character/Subsystems/ImpactEffectsSubsystem.h"
+#include "Character/Subsystems/TracerSubsystem.h"
+#include "Character/Weapon/Projectile.h"
+#include "GameFramework/Pawn.h"
+#include "RPG/RPG.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile Simulation"), STAT_ProjectileSimulation, STATGROUP_RPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Simulated Projectiles"), STAT_SimulatedProjectiles, STATGROUP_RPG);
+
+bool UProjectileSimulationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UProjectileSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSimulationSubsystem, STATGROUP_Tickables);
+}
+
+int32 UProjectileSimulationSubsystem::FindOrAddType(TSubclassOf<AProjectile> ProjectileClass)
+{
+	int32 TypeIndex = ProjectileTypes.Find(ProjectileClass);
+	if (TypeIndex == INDEX_NONE && ProjectileTypes.Num() <= MAX_uint8)
+	{
+		TypeIndex = ProjectileTypes.Add(ProjectileClass);
+	}
+	return TypeIndex;
+}
+
+void UProjectileSimulationSubsystem::SpawnProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Origin,
+                                                     const FVector& Direction, float Speed, APawn* InstigatorPawn,
+                                                     AActor* DamageCauser, bool bAuthoritative, float CatchUpTime)
+{
+	if (ProjectileClass == nullptr || GetWorld() == nullptr) return;
+	// Too old to be worth showing, e.g. events still in a weapon's spawn log when it becomes relevant
+	if (CatchUpTime > MaxCatchUpTime) return;
+
+	const int32 TypeIndex = FindOrAddType(ProjectileClass);
+	if (TypeIndex == INDEX_NONE) return;
+
+	const AProjectile* Defaults = ProjectileClass->GetDefaultObject<AProjectile>();
+	Positions.Add(Origin);
+	Velocities.Add(Direction.GetSafeNormal() * Speed);
+	GravityZ.Add(GetWorld()->GetGravityZ() * Defaults->GetGravityScale());
+	Damages.Add(Defaults->GetDamage());
+	Lifetimes.Add(Defaults->GetMaxLifetime());
+	CatchUpTimes.Add(FMath::Max(CatchUpTime, 0.f));
+	TypeIndices.Add(static_cast<uint8>(TypeIndex));
+	Authoritative.Add(bAuthoritative);
+	Instigators.Add(InstigatorPawn);
+	DamageCausers.Add(DamageCauser ? DamageCauser : InstigatorPawn);
+
+	UTracerSubsystem* Tracers = GetWorld()->GetSubsystem<UTracerSubsystem>();
+	TracerIds.Add(Tracers ? Tracers->StartTracer(Origin, Direction, Speed, Speed * Defaults->GetMaxLifetime(), GravityZ.Last()) : INDEX_NONE);
+}
+
+void UProjectileSimulationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SET_DWORD_STAT(STAT_SimulatedProjectiles, Positions.Num());
+	if (Positions.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileSimulation);
+	Integrate(DeltaTime);
+	Sweep();
+	ResolveHits();
+}
+
+void UProjectileSimulationSubsystem::Integrate(float DeltaTime)
+{
+	const int32 Num = Positions.Num();
+	PreviousPositions = Positions;
+
+	FVector* RESTRICT Position = Positions.GetData();
+	FVector* RESTRICT Velocity = Velocities.GetData();
+	const float* RESTRICT Gravity = GravityZ.GetData();
+	float* RESTRICT Lifetime = Lifetimes.GetData();
+	float* RESTRICT CatchUp = CatchUpTimes.GetData();
+	for (int32 i = 0; i < Num; ++i)
+	{
+		// Catch-up is folded into the first step so the sweep still covers the skipped segment
+		const float Step = DeltaTime + CatchUp[i];
+		CatchUp[i] = 0.f;
+
+		const FVector Acceleration(0.f, 0.f, Gravity[i]);
+		Position[i] += Velocity[i] * Step + 0.5f * Acceleration * Step * Step;
+		Velocity[i] += Acceleration * Step;
+		Lifetime[i] -= Step;
+	}
+}
+
+void UProjectileSimulationSubsystem::Sweep()
+{
+	const int32 Num = Positions.Num();
+	SweepHits.SetNum(Num, EAllowShrinking::No);
+	HitFlags.SetNum(Num, EAllowShrinking::No);
+
+	// Weak pointers are resolved here, the workers only see raw pointers
+	IgnoredActors.SetNum(Num, EAllowShrinking::No);
+	for (int32 i = 0; i < Num; ++i)
+	{
+		IgnoredActors[i] = Instigators[i].Get();
+	}
+
+	const UWorld* World = GetWorld();
+	ParallelFor(Num, [this, World](int32 i)
+	{
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileSweep), false, IgnoredActors[i]);
+		QueryParams.bReturnPhysicalMaterial = true;
+		HitFlags[i] = World->LineTraceSingleByChannel(
+			SweepHits[i],
+			PreviousPositions[i],
+			Positions[i],
+			ECC_WeaponTrace,
+			QueryParams);
+	}, Num < MinParallelSweeps ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void UProjectileSimulationSubsystem::ResolveHits()
+{
+	UDamagePipelineSubsystem* DamagePipeline = GetWorld()->GetSubsystem<UDamagePipelineSubsystem>();
+	UTracerSubsystem* Tracers = GetWorld()->GetSubsystem<UTracerSubsystem>();
+
+	// Walk backwards so swap-removal never skips a projectile
+	for (int32 i = Positions.Num() - 1; i >= 0; --i)
+	{
+		if (HitFlags[i])
+		{
+			const FHitResult& Hit = SweepHits[i];
+			APawn* InstigatorPawn = Instigators[i].Get();
+			AController* InstigatorController = InstigatorPawn ? InstigatorPawn->GetController() : nullptr;
+			if (Authoritative[i] && DamagePipeline && InstigatorController && Hit.GetActor() && DamageCausers[i].IsValid())
+			{
+				DamagePipeline->QueueDamage(
+					Hit.GetActor(),
+					Damages[i],
+					InstigatorController,
+					DamageCausers[i].Get()
+				);
+			}
+
+			const AProjectile* Defaults = ProjectileTypes[TypeIndices[i]]->GetDefaultObject<AProjectile>();
+			Defaults->SpawnImpactEffects(this, Hit.ImpactPoint, Hit.ImpactNormal.Rotation(), UImpactEffectsSubsystem::GetSurfaceType(Hit));
+			if (Tracers)
+			{
+				Tracers->EndTracer(TracerIds[i], Hit.ImpactPoint);
+			}
+			RemoveProjectile(i);
+		}
+		else if (Lifetimes[i] <= 0.f)
+		{
+			RemoveProjectile(i);
+		}
+	}
+}
+
+void UProjectileSimulationSubsystem::RemoveProjectile(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	GravityZ.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Damages.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Lifetimes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	CatchUpTimes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TypeIndices.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Authoritative.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Instigators.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	DamageCausers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TracerIds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Subsystems/TracerSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Materials/MaterialInterface.h"
+#include "RPG/RPG.h"
+
+DECLARE_CYCLE_STAT(TEXT("Tracers"), STAT_Tracers, STATGROUP_RPG);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Tracers"), STAT_LiveTracers, STATGROUP_RPG);
+
+bool UTracerSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if UE_SERVER
+	return false;
+#else
+	return Super::ShouldCreateSubsystem(Outer);
+#endif
+}
+
+bool UTracerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UTracerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTracerSubsystem, STATGROUP_Tickables);
+}
+
+bool UTracerSubsystem::EnsureRenderer()
+{
+	if (Renderer) return true;
+
+	UWorld* World = GetWorld();
+	UStaticMesh* Mesh = TracerMesh.LoadSynchronous();
+	if (World == nullptr || Mesh == nullptr) return false;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	RendererActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+	if (RendererActor == nullptr) return false;
+
+	Renderer = NewObject<UInstancedStaticMeshComponent>(RendererActor);
+	Renderer->SetMobility(EComponentMobility::Movable);
+	Renderer->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Renderer->SetCastShadow(false);
+	Renderer->SetStaticMesh(Mesh);
+	if (UMaterialInterface* Material = TracerMaterial.LoadSynchronous())
+	{
+		Renderer->SetMaterial(0, Material);
+	}
+	RendererActor->SetRootComponent(Renderer);
+	Renderer->RegisterComponent();
+
+	MeshSize = Mesh->GetBoundingBox().GetSize().ComponentMax(FVector(KINDA_SMALL_NUMBER));
+	return true;
+}
+
+int32 UTracerSubsystem::StartTracer(const FVector& Start, const FVector& Direction, float Speed, float MaxDistance, float InGravityZ)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || World->GetNetMode() == NM_DedicatedServer || Speed <= 0.f) return INDEX_NONE;
+	if (!EnsureRenderer()) return INDEX_NONE;
+
+	const int32 TracerId = NextTracerId++;
+	TracerIds.Add(TracerId);
+	Origins.Add(Start);
+	Directions.Add(Direction.GetSafeNormal());
+	Speeds.Add(Speed);
+	GravityZ.Add(InGravityZ);
+	Ages.Add(0.f);
+	MaxAges.Add(MaxDistance / Speed);
+	return TracerId;
+}
+
+void UTracerSubsystem::AddTracer(const FVector& Start, const FVector& End, float Speed)
+{
+	StartTracer(Start, End - Start, Speed, FVector::Dist(Start, End));
+}
+
+void UTracerSubsystem::EndTracer(int32 TracerId, const FVector& Location)
+{
+	if (TracerId == INDEX_NONE) return;
+
+	const int32 Index = TracerIds.Find(TracerId);
+	if (Index == INDEX_NONE) return;
+
+	// Time at which the path is as far along its launch direction as Location:
+	// Speed * t + 0.5 * g * Direction.Z * t^2 = Distance
+	const float Distance = FMath::Max((Location - Origins[Index]) | Directions[Index], 0.f);
+	const float Speed = Speeds[Index];
+	const float HalfAccel = 0.5f * GravityZ[Index] * Directions[Index].Z;
+	float Age = Distance / Speed;
+	const float Discriminant = Speed * Speed + 4.f * HalfAccel * Distance;
+	if (!FMath::IsNearlyZero(HalfAccel) && Discriminant >= 0.f)
+	{
+		Age = (FMath::Sqrt(Discriminant) - Speed) / (2.f * HalfAccel);
+	}
+	MaxAges[Index] = FMath::Min(MaxAges[Index], FMath::Max(Age, 0.f));
+}
+
+FVector UTracerSubsystem::GetPathLocation(int32 Index, float Age) const
+{
+	return Origins[Index] + Directions[Index] * (Speeds[Index] * Age) + FVector(0.f, 0.f, 0.5f * GravityZ[Index] * Age * Age);
+}
+
+void UTracerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SET_DWORD_STAT(STAT_LiveTracers, Origins.Num());
+	if (Renderer == nullptr) return;
+	if (Origins.Num() == 0 && Renderer->GetInstanceCount() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_Tracers);
+
+	// Walk backwards so swap-removal never skips a tracer
+	for (int32 i = Origins.Num() - 1; i >= 0; --i)
+	{
+		Ages[i] += DeltaTime;
+		// Gone once the tail has passed the end of the path
+		if (Ages[i] - TracerLength / Speeds[i] >= MaxAges[i])
+		{
+			RemoveTracer(i);
+		}
+	}
+	UpdateRenderer();
+}
+
+void UTracerSubsystem::UpdateRenderer()
+{
+	InstanceTransforms.Reset();
+	for (int32 i = 0; i < Origins.Num(); ++i)
+	{
+		const float HeadAge = FMath::Min(Ages[i], MaxAges[i]);
+		const float TailAge = FMath::Max(Ages[i] - TracerLength / Speeds[i], 0.f);
+		if (HeadAge <= TailAge) continue;
+
+		// The streak is short enough to draw as the chord between its ends on the arc
+		const FVector Head = GetPathLocation(i, HeadAge);
+		const FVector Tail = GetPathLocation(i, TailAge);
+		const FVector Segment = Head - Tail;
+		const float Length = Segment.Size();
+		if (Length <= KINDA_SMALL_NUMBER) continue;
+
+		const FVector Center = (Head + Tail) * 0.5f;
+		const FVector Scale(TracerWidth / MeshSize.X, TracerWidth / MeshSize.Y, Length / MeshSize.Z);
+		InstanceTransforms.Add(FTransform(FRotationMatrix::MakeFromZ(Segment / Length).ToQuat(), Center, Scale));
+	}
+
+	// Instances are interchangeable, so only the count changes and the transforms are rewritten
+	const int32 Current = Renderer->GetInstanceCount();
+	if (InstanceTransforms.Num() > Current)
+	{
+		Renderer->AddInstances(TArray<FTransform>(InstanceTransforms.GetData() + Current, InstanceTransforms.Num() - Current), false, true);
+	}
+	else if (InstanceTransforms.Num() < Current)
+	{
+		TArray<int32> Removed;
+		for (int32 Index = Current - 1; Index >= InstanceTransforms.Num(); --Index)
+		{
+			Removed.Add(Index);
+		}
+		Renderer->RemoveInstances(Removed);
+	}
+	if (InstanceTransforms.Num() > 0)
+	{
+		Renderer->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true);
+	}
+}
+
+void UTracerSubsystem::RemoveTracer(int32 Index)
+{
+	TracerIds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Origins.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Directions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Speeds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	GravityZ.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Ages.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	MaxAges.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Weapon/AmmoInventory.h"
+
+void FAmmoInventory::Set(EWeaponType Type, int32 Amount)
+{
+	if (IsValidType(Type))
+	{
+		Counts[static_cast<int32>(Type)] = FMath::Max(Amount, 0);
+	}
+}
+
+bool FAmmoInventory::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// Packed ints keep typical counts to a byte each
+	for (int32 i = 0; i < NumTypes; ++i)
+	{
+		uint32 Count = static_cast<uint32>(Counts[i]);
+		Ar.SerializeIntPacked(Count);
+		if (Ar.IsLoading())
+		{
+			Counts[i] = static_cast<int32>(FMath::Min<uint32>(Count, MAX_int32));
+		}
+	}
+	bOutSuccess = true;
+	return true;
+}
+
+bool FAmmoInventory::operator==(const FAmmoInventory& Other) const
+{
+	return FMemory::Memcmp(Counts, Other.Counts, sizeof(Counts)) == 0;
+}
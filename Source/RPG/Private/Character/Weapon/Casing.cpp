@@ -3,39 +3,19 @@
 
 #include "Character/Weapon/Casing.h"
 
-#include "Kismet/GameplayStatics.h"
+#include "Components/StaticMeshComponent.h"
 #include "Sound/SoundCue.h"
 
-// Sets default values
 ACasing::ACasing()
 {
 	PrimaryActorTick.bCanEverTick = false;
 
 	CasingMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("CasingMesh"));
 	SetRootComponent(CasingMesh);
-	CasingMesh->SetCollisionResponseToChannel(ECC_Camera,ECR_Ignore);
-	CasingMesh->SetSimulatePhysics(true);
-	CasingMesh->SetEnableGravity(true);
-	CasingMesh->SetNotifyRigidBodyCollision(true);
-	ShellEjectionImpulse = 10.f;
-	
+	CasingMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 }
 
-void ACasing::BeginPlay()
+UStaticMesh* ACasing::GetCasingMesh() const
 {
-	Super::BeginPlay();
-
-	CasingMesh->OnComponentHit.AddDynamic(this, &ACasing::OnHit);
-	CasingMesh->AddImpulse(GetActorForwardVector() * ShellEjectionImpulse);
+	return CasingMesh ? CasingMesh->GetStaticMesh() : nullptr;
 }
-
-void ACasing::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-	FVector NormalImpulse, const FHitResult& Hit)
-{
-	if (ShellSound)
-	{
-		UGameplayStatics::PlaySoundAtLocation(GetWorld(), ShellSound, GetActorLocation());
-	}
-	Destroy();
-}
-
@@ -3,64 +3,102 @@
 
 #include "Character/Weapon/HitScanWeapon.h"
 
-#include "Character/MainCharacter.h"
-#include "Engine/SkeletalMeshSocket.h"
-#include "Kismet/GameplayStatics.h"
+#include "Character/Subsystems/ImpactEffectsSubsystem.h"
+#include "Character/Subsystems/LagCompensationSubsystem.h"
+#include "Character/Subsystems/TracerSubsystem.h"
+#include "Character/Weapon/WeaponDefinition.h"
+#include "RPG/RPG.h"
 
-void AHitScanWeapon::Fire(const FVector& HitTarget)
+void AHitScanWeapon::PostLoad()
 {
-	Super::Fire(HitTarget);
+	Super::PostLoad();
 
+	if (ImpactParticles_DEPRECATED == nullptr) return;
+
+	if (UWeaponDefinition* LegacyDefinition = GetOrCreateLegacyDefinition())
+	{
+		LegacyDefinition->ImpactParticles = ImpactParticles_DEPRECATED;
+	}
+	ImpactParticles_DEPRECATED = nullptr;
+}
+
+void AHitScanWeapon::Fire(const FVector& HitTarget, uint16 SpreadSeed)
+{
+	Super::Fire(HitTarget, SpreadSeed);
+
+#if !UE_SERVER
+	// Tracers and impacts only, hits are resolved by SubmitRewindShot. Nothing to show on a dedicated server
 	APawn* OwnerPawn = Cast<APawn>(GetOwner());
-	if (OwnerPawn == nullptr) return;
-	AController* InstigatorController = OwnerPawn->GetController();
+	if (OwnerPawn == nullptr || GetNetMode() == NM_DedicatedServer) return;
 
-	const USkeletalMeshSocket* MuzzleFlashSocket = GetWeaponMesh()->GetSocketByName("MuzzleFlash");
-	if (MuzzleFlashSocket && InstigatorController)
+	FTransform SocketTransform;
+	UWorld* World = GetWorld();
+	if (GetMuzzleTransform(SocketTransform) && World)
 	{
-		FTransform SocketTransform = MuzzleFlashSocket->GetSocketTransform(GetWeaponMesh());
 		FVector Start = SocketTransform.GetLocation();
-		FVector End = Start + (HitTarget - Start) * 1.25f;
 
-		FHitResult FireHit;
-		UWorld* World = GetWorld();
-		if (World)
+		const UWeaponDefinition* WeaponDefinition = GetDefinition();
+		const UImpactEffectTable* ImpactEffects = WeaponDefinition ? WeaponDefinition->ImpactEffects.Get() : nullptr;
+		FImpactEffect DefaultImpact;
+		DefaultImpact.Particles = WeaponDefinition ? WeaponDefinition->ImpactParticles.Get() : nullptr;
+		UImpactEffectsSubsystem* ImpactEffectsSubsystem = World->GetSubsystem<UImpactEffectsSubsystem>();
+		UTracerSubsystem* Tracers = World->GetSubsystem<UTracerSubsystem>();
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(HitScanFire));
+		QueryParams.bReturnPhysicalMaterial = true;
+		TArray<FVector> Ends;
+		BuildTraceEnds(Start, HitTarget, SpreadSeed, Ends);
+		for (const FVector& End : Ends)
 		{
+			FHitResult FireHit;
 			World->LineTraceSingleByChannel(
 				FireHit,
 				Start,
 				End,
-				ECC_Visibility);
-			if (FireHit.bBlockingHit)
+				ECC_WeaponTrace,
+				QueryParams);
+			if (Tracers)
 			{
-				AMainCharacter* MainCharacter = Cast<AMainCharacter>(FireHit.GetActor());
-				if (MainCharacter)
-				{
-					if (HasAuthority())
-					{
-						FVector HitDirection = (FireHit.ImpactPoint - Start).GetSafeNormal();
-
-						UGameplayStatics::ApplyPointDamage(
-							MainCharacter,
-							Damage,
-							HitDirection,
-							FireHit,
-							InstigatorController,
-							this,
-							UDamageType::StaticClass()
-							);
-					}
-				}
-				if (ImpactParticles)
-				{
-					UGameplayStatics::SpawnEmitterAtLocation(
-						World,
-						ImpactParticles,
-						FireHit.ImpactPoint,
-						FireHit.ImpactNormal.Rotation()
-						);
-				}
+				Tracers->AddTracer(Start, FireHit.bBlockingHit ? FireHit.ImpactPoint : End, TracerSpeed);
+			}
+			if (FireHit.bBlockingHit && ImpactEffectsSubsystem)
+			{
+				// Pellets landing together are merged by the subsystem
+				ImpactEffectsSubsystem->QueueImpact(
+					ImpactEffects ? ImpactEffects->FindEffect(UImpactEffectsSubsystem::GetSurfaceType(FireHit)) : DefaultImpact,
+					FireHit.ImpactPoint,
+					FireHit.ImpactNormal.Rotation()
+					);
 			}
 		}
 	}
+#endif
+}
+
+void AHitScanWeapon::BuildTraceEnds(const FVector& Start, const FVector& HitTarget, uint16 SpreadSeed, TArray<FVector>& OutEnds) const
+{
+	OutEnds.Add(Start + (HitTarget - Start) * 1.25f);
+}
+
+void AHitScanWeapon::SubmitRewindShot(const FVector& MuzzleLocation, const FVector& HitTarget, float HitTime, uint16 SpreadSeed)
+{
+	if (!HasAuthority()) return;
+
+	APawn* OwnerPawn = Cast<APawn>(GetOwner());
+	if (OwnerPawn == nullptr) return;
+	AController* InstigatorController = OwnerPawn->GetController();
+
+	ULagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>();
+	if (InstigatorController && LagCompensation)
+	{
+		FRewindShot Shot;
+		Shot.Shooter = OwnerPawn;
+		Shot.InstigatorController = InstigatorController;
+		Shot.DamageCauser = this;
+		Shot.Start = MuzzleLocation;
+		BuildTraceEnds(Shot.Start, HitTarget, SpreadSeed, Shot.Ends);
+		Shot.HitTime = HitTime;
+		Shot.Damage = Damage;
+		LagCompensation->QueueShot(Shot);
+	}
 }
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Weapon/ImpactEffectTable.h"
+
+void UImpactEffectTable::BuildLookup() const
+{
+	SurfaceToEffect.Init(0, SurfaceType_Max);
+	Effects.Reset();
+	for (const TPair<TEnumAsByte<EPhysicalSurface>, FImpactEffect>& Entry : SurfaceEffects)
+	{
+		if (Entry.Key < SurfaceType_Max && Effects.Num() < MAX_uint8)
+		{
+			SurfaceToEffect[Entry.Key] = static_cast<uint8>(Effects.Add(Entry.Value) + 1);
+		}
+	}
+}
+
+const FImpactEffect& UImpactEffectTable::FindEffect(EPhysicalSurface SurfaceType) const
+{
+	if (SurfaceToEffect.Num() == 0)
+	{
+		BuildLookup();
+	}
+	const uint8 EffectIndex = SurfaceType < SurfaceType_Max ? SurfaceToEffect[SurfaceType] : 0;
+	return EffectIndex == 0 ? DefaultEffect : Effects[EffectIndex - 1];
+}
+
+#if WITH_EDITOR
+void UImpactEffectTable::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	SurfaceToEffect.Reset();
+}
+#endif
@@ -4,9 +4,12 @@
 #include "Character/Weapon/Projectile.h"
 
 #include "Character/MainCharacter.h"
+#include "Character/Subsystems/ImpactEffectsSubsystem.h"
+#include "Character/Subsystems/ProjectilePoolSubsystem.h"
+#include "Character/Subsystems/TracerSubsystem.h"
 #include "Components/BoxComponent.h"
 #include "GameFramework/ProjectileMovementComponent.h"
-#include "Kismet/GameplayStatics.h"
+#include "Net/UnrealNetwork.h"
 #include "RPG/RPG.h"
 #include "Sound/SoundCue.h"
 
@@ -23,37 +26,80 @@ AProjectile::AProjectile()
 	CollisionBox->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
 	CollisionBox->SetCollisionResponseToChannel(ECC_WorldStatic, ECR_Block);
 	CollisionBox->SetCollisionResponseToChannel(ECC_SkeletalMesh, ECR_Block);
+	// Hits carry the physical material, so impacts can match the surface
+	CollisionBox->bReturnMaterialOnMove = true;
 
 	ProjectileMovementComponent = CreateDefaultSubobject<UProjectileMovementComponent>(TEXT("ProjectileMovementComponent"));
 	ProjectileMovementComponent->bRotationFollowsVelocity = true;
 }
 
+void AProjectile::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(AProjectile, bPooled, COND_InitialOnly);
+	DOREPLIFETIME(AProjectile, FlightState);
+}
+
 void AProjectile::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (Tracer)
+	// Clients only record the surface of their own copy's hit, the server decides when it lands
+	CollisionBox->OnComponentHit.AddDynamic(this, &AProjectile::OnHit);
+
+	if (bPooled)
 	{
-		TracerComponent = UGameplayStatics::SpawnEmitterAttached(
-			Tracer,
-			CollisionBox,
-			FName(),
-			GetActorLocation(),
-			GetActorRotation(),
-			EAttachLocation::KeepWorldPosition
-		);
+		// Pooled projectiles start parked unless they already have a flight to join
+		AppliedFlightId = FlightState.FlightId;
+		if (FlightState.bInFlight)
+		{
+			StartFlight(FlightState.Location, FlightState.Direction);
+		}
+		else
+		{
+			Park();
+		}
 	}
+	else
+	{
+		StartTracer(GetActorLocation(), GetActorForwardVector());
+	}
+}
 
-	if (HasAuthority())
+void AProjectile::StartTracer(const FVector& Location, const FVector& Direction)
+{
+	UTracerSubsystem* Tracers = GetWorld()->GetSubsystem<UTracerSubsystem>();
+	if (!bDrawTracer || Tracers == nullptr) return;
+
+	const float Speed = GetInitialSpeed();
+	TracerId = Tracers->StartTracer(Location, Direction, Speed, Speed * MaxLifetime, GetWorld()->GetGravityZ() * GetGravityScale());
+}
+
+void AProjectile::EndTracer()
+{
+	UTracerSubsystem* Tracers = GetWorld() ? GetWorld()->GetSubsystem<UTracerSubsystem>() : nullptr;
+	if (Tracers)
 	{
-		CollisionBox->OnComponentHit.AddDynamic(this, &AProjectile::OnHit);
+		Tracers->EndTracer(TracerId, GetActorLocation());
 	}
+	TracerId = INDEX_NONE;
 }
 
 void AProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp,
 	FVector NormalImpulse, const FHitResult& Hit)
 {
-	Destroy();
+	ImpactSurface = UImpactEffectsSubsystem::GetSurfaceType(Hit);
+	if (!HasAuthority()) return;
+
+	if (bPooled)
+	{
+		ReturnToPool(true);
+	}
+	else
+	{
+		Destroy();
+	}
 }
 
 void AProjectile::Tick(float DeltaTime)
@@ -65,12 +111,139 @@ void AProjectile::Destroyed()
 {
 	Super::Destroyed();
 
-	if (ImpactParticles)
+#if !UE_SERVER
+	if (!bPooled)
+	{
+		EndTracer();
+		PlayImpactEffects();
+	}
+#endif
+}
+
+void AProjectile::PlayImpactEffects()
+{
+#if !UE_SERVER
+	SpawnImpactEffects(this, GetActorLocation(), GetActorRotation(), ImpactSurface);
+#endif
+}
+
+void AProjectile::SpawnImpactEffects(const UObject* WorldContextObject, const FVector& Location, const FRotator& Rotation,
+                                     EPhysicalSurface SurfaceType) const
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	UImpactEffectsSubsystem* ImpactEffectsSubsystem = World ? World->GetSubsystem<UImpactEffectsSubsystem>() : nullptr;
+	if (ImpactEffectsSubsystem == nullptr) return;
+
+	if (ImpactEffects)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, GetActorTransform());
+		ImpactEffectsSubsystem->QueueImpact(ImpactEffects->FindEffect(SurfaceType), Location, Rotation);
 	}
-	if (ImpactSound)
+	else
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, GetActorLocation());
+		FImpactEffect Effect;
+		Effect.Particles = ImpactParticles;
+		Effect.Sound = ImpactSound;
+		ImpactEffectsSubsystem->QueueImpact(Effect, Location, Rotation);
 	}
 }
+
+float AProjectile::GetInitialSpeed() const
+{
+	return ProjectileMovementComponent ? ProjectileMovementComponent->InitialSpeed : 0.f;
+}
+
+float AProjectile::GetGravityScale() const
+{
+	return ProjectileMovementComponent ? ProjectileMovementComponent->ProjectileGravityScale : 1.f;
+}
+
+void AProjectile::LaunchFromPool(const FVector& Location, const FVector& Direction)
+{
+	FlightState.FlightId++;
+	FlightState.bInFlight = true;
+	FlightState.bHit = false;
+	FlightState.SurfaceType = SurfaceType_Default;
+	FlightState.Location = Location;
+	FlightState.Direction = Direction;
+	AppliedFlightId = FlightState.FlightId;
+	StartFlight(Location, Direction);
+
+	GetWorldTimerManager().SetTimer(PooledLifetimeTimer, this, &AProjectile::ExpireFlight, MaxLifetime);
+}
+
+void AProjectile::ExpireFlight()
+{
+	ReturnToPool(false);
+}
+
+void AProjectile::ReturnToPool(bool bHit)
+{
+	if (!FlightState.bInFlight) return;
+
+	GetWorldTimerManager().ClearTimer(PooledLifetimeTimer);
+	FlightState.bInFlight = false;
+	FlightState.bHit = bHit;
+	FlightState.SurfaceType = bHit ? ImpactSurface : TEnumAsByte<EPhysicalSurface>(SurfaceType_Default);
+	FlightState.Location = GetActorLocation();
+	if (bHit)
+	{
+		PlayImpactEffects();
+	}
+	Park();
+
+	UProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>();
+	if (ProjectilePool)
+	{
+		ProjectilePool->ReleaseProjectile(this);
+	}
+}
+
+void AProjectile::OnRep_FlightState()
+{
+	if (FlightState.bInFlight)
+	{
+		AppliedFlightId = FlightState.FlightId;
+		StartFlight(FlightState.Location, FlightState.Direction);
+		return;
+	}
+
+	// Landed. A flight we never saw start still gets its impact
+	const bool bWasInFlight = bFlying || AppliedFlightId != FlightState.FlightId;
+	AppliedFlightId = FlightState.FlightId;
+	ImpactSurface = FlightState.SurfaceType;
+	SetActorLocation(FlightState.Location);
+	if (bWasInFlight && FlightState.bHit)
+	{
+		PlayImpactEffects();
+	}
+	Park();
+}
+
+void AProjectile::StartFlight(const FVector& Location, const FVector& Direction)
+{
+	bFlying = true;
+	ImpactSurface = SurfaceType_Default;
+	SetActorLocationAndRotation(Location, Direction.Rotation(), false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	ProjectileMovementComponent->SetUpdatedComponent(CollisionBox);
+	ProjectileMovementComponent->Velocity = Direction * ProjectileMovementComponent->InitialSpeed;
+	ProjectileMovementComponent->Activate(true);
+	ProjectileMovementComponent->UpdateComponentVelocity();
+
+	EndTracer();
+	StartTracer(Location, Direction);
+}
+
+void AProjectile::Park()
+{
+	bFlying = false;
+	ProjectileMovementComponent->StopMovementImmediately();
+	ProjectileMovementComponent->Deactivate();
+	EndTracer();
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+}
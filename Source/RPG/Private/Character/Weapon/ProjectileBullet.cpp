@@ -3,29 +3,25 @@
 
 #include "Character/Weapon/ProjectileBullet.h"
 
+#include "Character/Subsystems/DamagePipelineSubsystem.h"
 #include "GameFramework/Character.h"
-#include "Kismet/GameplayStatics.h"
 
 void AProjectileBullet::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp,
                               FVector NormalImpulse, const FHitResult& Hit)
 {
-
+	// Clients only see their copy of the hit, damage is the server's call
 	ACharacter* OwnerCharacter = Cast<ACharacter>(GetOwner());
-	if (OwnerCharacter)
+	if (OwnerCharacter && HasAuthority())
 	{
 		AController* OwnerController = OwnerCharacter->Controller;
-		if (OwnerController)
+		UDamagePipelineSubsystem* DamagePipeline = GetWorld()->GetSubsystem<UDamagePipelineSubsystem>();
+		if (OwnerController && DamagePipeline)
 		{
-			FVector HitDirection = (Hit.ImpactPoint - GetActorLocation()).GetSafeNormal();
-
-			UGameplayStatics::ApplyPointDamage(
+			DamagePipeline->QueueDamage(
 					OtherActor,
 					Damage,
-					HitDirection,
-					Hit,
 					OwnerController,
-					this,
-					UDamageType::StaticClass()
+					this
 				);
 		}
 	}
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Weapon/ProjectileSpawnLog.h"
+#include "Character/Weapon/ProjectileWeapon.h"
+
+void FProjectileSpawnEvent::PostReplicatedAdd(const FProjectileSpawnLog& InArraySerializer)
+{
+	if (InArraySerializer.OwnerWeapon)
+	{
+		InArraySerializer.OwnerWeapon->PlaySpawnEvent(*this);
+	}
+}
+
+void FProjectileSpawnLog::AddEvent(TSubclassOf<AProjectile> ProjectileClass, const FVector& Origin, const FVector& Direction,
+                                   float Speed, float ServerTime)
+{
+	if (Events.Num() >= MaxEvents)
+	{
+		Events.RemoveAt(0, Events.Num() - MaxEvents + 1);
+		MarkArrayDirty();
+	}
+
+	FProjectileSpawnEvent& Event = Events.AddDefaulted_GetRef();
+	Event.Origin = Origin;
+	Event.Direction = Direction;
+	Event.Speed = Speed;
+	Event.ProjectileClass = ProjectileClass;
+	Event.ServerTime = ServerTime;
+	MarkItemDirty(Event);
+}
@@ -3,32 +3,97 @@
 
 #include "Character/Weapon/ProjectileWeapon.h"
 
-#include "ViewportInteractionTypes.h"
+#include "Character/Subsystems/ProjectilePoolSubsystem.h"
+#include "Character/Subsystems/ProjectileSimulationSubsystem.h"
 #include "Character/Weapon/Projectile.h"
-#include "Engine/SkeletalMeshSocket.h"
+#include "GameFramework/GameStateBase.h"
+#include "Net/UnrealNetwork.h"
 
-void AProjectileWeapon::Fire(const FVector& HitTarget)
+AProjectileWeapon::AProjectileWeapon()
 {
-	Super::Fire(HitTarget);
+	SpawnLog.OwnerWeapon = this;
+}
+
+void AProjectileWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owner already flies its own predicted copy
+	DOREPLIFETIME_CONDITION(AProjectileWeapon, SpawnLog, COND_SkipOwner);
+}
+
+void AProjectileWeapon::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (HasAuthority() && bUseProjectilePool && !bSimulateProjectiles)
+	{
+		UProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>();
+		if (ProjectilePool)
+		{
+			ProjectilePool->Prewarm(ProjectileClass, PoolPrewarmCount);
+		}
+	}
+}
+
+void AProjectileWeapon::Fire(const FVector& HitTarget, uint16 SpreadSeed)
+{
+	Super::Fire(HitTarget, SpreadSeed);
 
-	if (!HasAuthority()) return;
+	if (!HasAuthority() && !bSimulateProjectiles) return;
 	
 	APawn* InstigatorPawn = Cast<APawn>(GetOwner());
-	const USkeletalMeshSocket* MuzzleFlashSocket =  GetWeaponMesh()->GetSocketByName(FName("MuzzleFlash"));
-	if (MuzzleFlashSocket)
+	FTransform SocketTransform;
+	if (GetMuzzleTransform(SocketTransform))
 	{
-		FTransform SocketTransform = MuzzleFlashSocket->GetSocketTransform(GetWeaponMesh());
 		// From muzzle socket to hit location from TraceUnderCrosshair
 		FVector ToTarget = HitTarget - SocketTransform.GetLocation();
 		FRotator TargetRotation = ToTarget.Rotation();
 		if (ProjectileClass && InstigatorPawn)
 		{
-			FActorSpawnParameters SpawnParams;
-			SpawnParams.Owner = GetOwner();
-			SpawnParams.Instigator = InstigatorPawn;
 			UWorld* World = GetWorld();
-			if (World)
+			if (bSimulateProjectiles)
 			{
+				// Other clients fly their copy from the replicated spawn event instead
+				if (!HasAuthority() && !InstigatorPawn->IsLocallyControlled()) return;
+
+				UProjectileSimulationSubsystem* ProjectileSimulation = World ? World->GetSubsystem<UProjectileSimulationSubsystem>() : nullptr;
+				if (ProjectileSimulation)
+				{
+					const float Speed = ProjectileClass->GetDefaultObject<AProjectile>()->GetInitialSpeed();
+					ProjectileSimulation->SpawnProjectile(
+						ProjectileClass,
+						SocketTransform.GetLocation(),
+						ToTarget,
+						Speed,
+						InstigatorPawn,
+						this,
+						HasAuthority()
+					);
+					if (HasAuthority())
+					{
+						SpawnLog.AddEvent(ProjectileClass, SocketTransform.GetLocation(), ToTarget.GetSafeNormal(), Speed, World->GetTimeSeconds());
+					}
+				}
+				return;
+			}
+
+			UProjectilePoolSubsystem* ProjectilePool = World ? World->GetSubsystem<UProjectilePoolSubsystem>() : nullptr;
+			if (bUseProjectilePool && ProjectilePool)
+			{
+				ProjectilePool->AcquireProjectile(
+					ProjectileClass,
+					SocketTransform.GetLocation(),
+					TargetRotation,
+					GetOwner(),
+					InstigatorPawn
+				);
+			}
+			else if (World)
+			{
+				FActorSpawnParameters SpawnParams;
+				SpawnParams.Owner = GetOwner();
+				SpawnParams.Instigator = InstigatorPawn;
 				World->SpawnActor<AProjectile>(
 					ProjectileClass,
 					SocketTransform.GetLocation(),
@@ -39,3 +104,24 @@ void AProjectileWeapon::Fire(const FVector& HitTarget)
 		}
 	}
 }
+
+void AProjectileWeapon::PlaySpawnEvent(const FProjectileSpawnEvent& Event)
+{
+	UWorld* World = GetWorld();
+	UProjectileSimulationSubsystem* ProjectileSimulation = World ? World->GetSubsystem<UProjectileSimulationSubsystem>() : nullptr;
+	if (ProjectileSimulation == nullptr || Event.ProjectileClass == nullptr) return;
+
+	AGameStateBase* GameState = World->GetGameState();
+	const float CatchUpTime = GameState ? GameState->GetServerWorldTimeSeconds() - Event.ServerTime : 0.f;
+
+	ProjectileSimulation->SpawnProjectile(
+		Event.ProjectileClass,
+		Event.Origin,
+		Event.Direction,
+		Event.Speed,
+		Cast<APawn>(GetOwner()),
+		this,
+		false,
+		CatchUpTime
+	);
+}
@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Weapon/Shotgun.h"
+
+void AShotgun::BuildTraceEnds(const FVector& Start, const FVector& HitTarget, uint16 SpreadSeed, TArray<FVector>& OutEnds) const
+{
+	const FVector ToTarget = HitTarget - Start;
+	const float TraceLength = ToTarget.Size() * 1.25f;
+	const FVector Direction = ToTarget.GetSafeNormal();
+	const float ConeHalfAngle = FMath::DegreesToRadians(SpreadAngle);
+
+	FRandomStream Spread(SpreadSeed);
+	OutEnds.Reserve(OutEnds.Num() + NumberOfPellets);
+	for (int32 i = 0; i < NumberOfPellets; ++i)
+	{
+		OutEnds.Add(Start + Spread.VRandCone(Direction, ConeHalfAngle) * TraceLength);
+	}
+}
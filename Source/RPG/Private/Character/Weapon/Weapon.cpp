@@ -4,11 +4,15 @@
 #include "Character/Weapon/Weapon.h"
 #include "Character/MainCharacter.h"
 #include "Character/PlayerController/CharacterPlayerController.h"
+#include "Character/Subsystems/CasingSubsystem.h"
 #include "Character/Weapon/Casing.h"
+#include "Character/Weapon/WeaponDefinition.h"
+#include "Engine/AssetManager.h"
 #include "Components/SphereComponent.h"
 #include "Components/WidgetComponent.h"
-#include "Engine/SkeletalMeshSocket.h"
 #include "Net/UnrealNetwork.h"
+#include "RPG/RPG.h"
+#include "Sound/SoundCue.h"
 
 // Sets default values
 AWeapon::AWeapon()
@@ -31,14 +35,137 @@ AWeapon::AWeapon()
 
 	PickupWidget = CreateDefaultSubobject<UWidgetComponent>(TEXT("PickupWidget"));
 	PickupWidget->SetupAttachment(RootComponent);
+
+	MuzzleFlashSocket = SocketCache.Add(FName("MuzzleFlash"));
+	AmmoEjectSocket = SocketCache.Add(FName("AmmoEject"));
+	LeftHandSocket = SocketCache.Add(FName("LeftHandSocket"));
+}
+
+void AWeapon::PreRegisterAllComponents()
+{
+	Super::PreRegisterAllComponents();
+
+	// Same subobjects in every build, the pickup prompt is just never registered on a dedicated server
+	if (PickupWidget && IsNetMode(NM_DedicatedServer))
+	{
+		PickupWidget->bAutoRegister = false;
+	}
+}
+
+void AWeapon::PostLoad()
+{
+	Super::PostLoad();
+
+	const bool bHasLegacyCosmetics = CrosshairsCenter_DEPRECATED || CrosshairsLeft_DEPRECATED ||
+		CrosshairsRight_DEPRECATED || CrosshairsTop_DEPRECATED || CrosshairsBottom_DEPRECATED ||
+		EquipSound_DEPRECATED || FireAnimation_DEPRECATED || CasingClass_DEPRECATED;
+	if (!bHasLegacyCosmetics) return;
+
+	if (UWeaponDefinition* LegacyDefinition = GetOrCreateLegacyDefinition())
+	{
+		LegacyDefinition->CrosshairsCenter = CrosshairsCenter_DEPRECATED;
+		LegacyDefinition->CrosshairsLeft = CrosshairsLeft_DEPRECATED;
+		LegacyDefinition->CrosshairsRight = CrosshairsRight_DEPRECATED;
+		LegacyDefinition->CrosshairsTop = CrosshairsTop_DEPRECATED;
+		LegacyDefinition->CrosshairsBottom = CrosshairsBottom_DEPRECATED;
+		LegacyDefinition->EquipSound = EquipSound_DEPRECATED;
+		LegacyDefinition->FireAnimation = FireAnimation_DEPRECATED;
+		LegacyDefinition->CasingClass = CasingClass_DEPRECATED.Get();
+	}
+	CrosshairsCenter_DEPRECATED = nullptr;
+	CrosshairsLeft_DEPRECATED = nullptr;
+	CrosshairsRight_DEPRECATED = nullptr;
+	CrosshairsTop_DEPRECATED = nullptr;
+	CrosshairsBottom_DEPRECATED = nullptr;
+	EquipSound_DEPRECATED = nullptr;
+	FireAnimation_DEPRECATED = nullptr;
+	CasingClass_DEPRECATED = nullptr;
+}
+
+UWeaponDefinition* AWeapon::GetOrCreateLegacyDefinition()
+{
+	if (Definition)
+	{
+		return Definition->GetOuter() == this ? Definition : nullptr;
+	}
+
+	// Owned by this weapon so it is saved with the Blueprint, and carries the stats the Blueprint already had
+	Definition = NewObject<UWeaponDefinition>(this, TEXT("LegacyDefinition"));
+	Definition->WeaponType = WeaponType;
+	Definition->MagCapacity = MagCapacity;
+	Definition->FireDelay = FireDelay;
+	Definition->bAutomatic = bAutomatic;
+	Definition->ZoomedFOV = ZoomedFOV;
+	Definition->ZoomInterpSpeed = ZoomInterpSpeed;
+	return Definition;
+}
+
+void AWeapon::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+	ApplyDefinition();
+}
+
+void AWeapon::ApplyDefinition()
+{
+	// Without a definition the stats set on the Blueprint are used as they are
+	if (Definition == nullptr) return;
+
+	WeaponType = Definition->WeaponType;
+	MagCapacity = Definition->MagCapacity;
+	FireDelay = Definition->FireDelay;
+	bAutomatic = Definition->bAutomatic;
+	ZoomedFOV = Definition->ZoomedFOV;
+	ZoomInterpSpeed = Definition->ZoomInterpSpeed;
+}
+
+void AWeapon::LoadCosmetics()
+{
+#if !UE_SERVER
+	// Cosmetics are never used on a dedicated server, so never loaded there
+	if (Definition == nullptr || GetNetMode() == NM_DedicatedServer) return;
+
+	UAssetManager& AssetManager = UAssetManager::Get();
+	if (Definition->IsAsset())
+	{
+		// The asset manager shares the load between every weapon using this definition
+		CosmeticsHandle = AssetManager.LoadPrimaryAsset(
+			Definition->GetPrimaryAssetId(),
+			{ UWeaponDefinition::ClientBundle }
+		);
+	}
+	else
+	{
+		// Legacy definitions live inside the weapon Blueprint and aren't registered as primary assets
+		TArray<FSoftObjectPath> Paths;
+		Definition->GetClientAssetPaths(Paths);
+		if (Paths.Num() > 0)
+		{
+			CosmeticsHandle = AssetManager.GetStreamableManager().RequestAsyncLoad(Paths);
+		}
+	}
+#endif
+}
+
+void AWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (CosmeticsHandle.IsValid())
+	{
+		CosmeticsHandle->ReleaseHandle();
+		CosmeticsHandle.Reset();
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 void AWeapon::BeginPlay()
 {
 	Super::BeginPlay();
 
+	LoadCosmetics();
+
 	if (HasAuthority())
 	{
+		AmmoState.Ammo = Ammo;
 		AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
 		AreaSphere->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
 		AreaSphere->OnComponentBeginOverlap.AddDynamic(this, &AWeapon::OnSphereOverlap);
@@ -60,7 +187,7 @@ void AWeapon::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLif
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
 	DOREPLIFETIME(AWeapon, WeaponState);
-	DOREPLIFETIME(AWeapon, Ammo)
+	DOREPLIFETIME(AWeapon, AmmoState);
 }
 
 void AWeapon::OnSphereOverlap(
@@ -107,11 +234,41 @@ void AWeapon::SetHudAmmo()
 void AWeapon::SpendRound()
 {
 	Ammo = FMath::Clamp(Ammo - 1, 0, MagCapacity);
+	if (HasAuthority())
+	{
+		AmmoState.Ammo = Ammo;
+	}
 	SetHudAmmo();
 }
 
-void AWeapon::OnRep_Ammo()
+uint16 AWeapon::PredictShot()
+{
+	return ++ShotSequence;
+}
+
+void AWeapon::AcknowledgeShot(uint16 Sequence)
+{
+	AmmoState.LastProcessedShot = Sequence;
+}
+
+void AWeapon::OnRep_AmmoState()
 {
+	OwnerCharacter = OwnerCharacter == nullptr ? Cast<AMainCharacter>(GetOwner()) : OwnerCharacter;
+	if (OwnerCharacter && OwnerCharacter->IsLocallyControlled())
+	{
+		// Re-apply the shots the server has not seen yet on top of its count
+		uint16 PendingShots = ShotSequence - AmmoState.LastProcessedShot;
+		if (PendingShots > MagCapacity)
+		{
+			ShotSequence = AmmoState.LastProcessedShot;
+			PendingShots = 0;
+		}
+		Ammo = FMath::Clamp(AmmoState.Ammo - PendingShots, 0, MagCapacity);
+	}
+	else
+	{
+		Ammo = AmmoState.Ammo;
+	}
 	SetHudAmmo();
 }
 
@@ -125,12 +282,18 @@ void AWeapon::OnRep_Owner()
 	}
 	else
 	{
+		ShotSequence = AmmoState.LastProcessedShot;
 		SetHudAmmo();
 	}
 }
 
 void AWeapon::SetWeaponState(EweaponState State)
 {
+	// Holstered weapons go dormant, wake them before the state change so it replicates
+	if (HasAuthority() && State != EweaponState::EWS_Holstered)
+	{
+		SetNetDormancy(DORM_Awake);
+	}
 	WeaponState = State;
 
 	switch (WeaponState)
@@ -141,6 +304,8 @@ void AWeapon::SetWeaponState(EweaponState State)
 		WeaponMesh->SetSimulatePhysics(false);
 		WeaponMesh->SetEnableGravity(false);
 		WeaponMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		WeaponMesh->SetComponentTickEnabled(true);
+		SetActorHiddenInGame(false);
 		break;
 	case EweaponState::EWS_Dropped:
 		if (HasAuthority())
@@ -150,6 +315,21 @@ void AWeapon::SetWeaponState(EweaponState State)
 		WeaponMesh->SetSimulatePhysics(true);
 		WeaponMesh->SetEnableGravity(true);
 		WeaponMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+		WeaponMesh->SetComponentTickEnabled(true);
+		SetActorHiddenInGame(false);
+		break;
+	case EweaponState::EWS_Holstered:
+		ShowPickupWidget(false);
+		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		WeaponMesh->SetSimulatePhysics(false);
+		WeaponMesh->SetEnableGravity(false);
+		WeaponMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		WeaponMesh->SetComponentTickEnabled(false);
+		SetActorHiddenInGame(true);
+		if (HasAuthority())
+		{
+			SetNetDormancy(DORM_DormantAll);
+		}
 		break;
 	}
 }
@@ -163,11 +343,20 @@ void AWeapon::OnRep_WeaponState()
 		WeaponMesh->SetSimulatePhysics(false);
 		WeaponMesh->SetEnableGravity(false);
 		WeaponMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		WeaponMesh->SetComponentTickEnabled(true);
 		break;
 	case EweaponState::EWS_Dropped:
 		WeaponMesh->SetSimulatePhysics(true);
 		WeaponMesh->SetEnableGravity(true);
 		WeaponMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+		WeaponMesh->SetComponentTickEnabled(true);
+		break;
+	case EweaponState::EWS_Holstered:
+		ShowPickupWidget(false);
+		WeaponMesh->SetSimulatePhysics(false);
+		WeaponMesh->SetEnableGravity(false);
+		WeaponMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		WeaponMesh->SetComponentTickEnabled(false);
 		break;
 	}
 }
@@ -180,29 +369,30 @@ void AWeapon::ShowPickupWidget(bool bShowWidget)
 	}
 }
 
-void AWeapon::Fire(const FVector& HitTarget)
+void AWeapon::Fire(const FVector& HitTarget, uint16 SpreadSeed)
 {
+#if !UE_SERVER
+	UAnimationAsset* FireAnimation = Definition ? Definition->FireAnimation.Get() : nullptr;
 	if (FireAnimation)
 	{
 		WeaponMesh->PlayAnimation(FireAnimation, false);
 	}
-	if (CasingClass)
+	UClass* CasingClass = Definition ? Definition->CasingClass.Get() : nullptr;
+	UCasingSubsystem* Casings = GetWorld() ? GetWorld()->GetSubsystem<UCasingSubsystem>() : nullptr;
+	if (CasingClass && Casings)
 	{
-		const USkeletalMeshSocket* AmmoEjectSocket = WeaponMesh->GetSocketByName(FName("AmmoEject"));
-		if (AmmoEjectSocket)
+		FTransform SocketTransform;
+		if (SocketCache.GetTransform(WeaponMesh, AmmoEjectSocket, SocketTransform))
 		{
-			FTransform SocketTransform = AmmoEjectSocket->GetSocketTransform(WeaponMesh);
-			UWorld* World = GetWorld();
-			if (World)
-			{
-				World->SpawnActor<ACasing>(
-					CasingClass,
-					SocketTransform.GetLocation(),
-					SocketTransform.GetRotation().Rotator()
-				);
-			}
+			const AActor* OwnerActor = GetOwner();
+			Casings->EjectCasing(
+				CasingClass,
+				SocketTransform,
+				OwnerActor ? OwnerActor->GetVelocity() : FVector::ZeroVector
+			);
 		}
 	}
+#endif
 	SpendRound();
 }
 
@@ -219,6 +409,10 @@ void AWeapon::Dropped()
 void AWeapon::AddAmmo(int32 AmmoToAdd)
 {
 	Ammo = FMath::Clamp(Ammo - AmmoToAdd, 0, MagCapacity);
+	if (HasAuthority())
+	{
+		AmmoState.Ammo = Ammo;
+	}
 	SetHudAmmo();
 }
 
@@ -226,3 +420,24 @@ bool AWeapon::IsEmpty()
 {
 	return Ammo <= 0;
 }
+
+USoundCue* AWeapon::GetEquipSound() const
+{
+	return Definition ? Definition->EquipSound.Get() : nullptr;
+}
+
+FVector AWeapon::GetMuzzleLocation() const
+{
+	FTransform MuzzleTransform;
+	return GetMuzzleTransform(MuzzleTransform) ? MuzzleTransform.GetLocation() : GetActorLocation();
+}
+
+bool AWeapon::GetMuzzleTransform(FTransform& OutTransform) const
+{
+	return SocketCache.GetTransform(WeaponMesh, MuzzleFlashSocket, OutTransform);
+}
+
+bool AWeapon::GetLeftHandSocketTransform(FTransform& OutTransform) const
+{
+	return SocketCache.GetTransform(WeaponMesh, LeftHandSocket, OutTransform);
+}
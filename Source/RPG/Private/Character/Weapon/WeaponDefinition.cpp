@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Character/Weapon/WeaponDefinition.h"
+
+const FPrimaryAssetType UWeaponDefinition::PrimaryAssetType = TEXT("WeaponDefinition");
+const FName UWeaponDefinition::ClientBundle = TEXT("Client");
+
+FPrimaryAssetId UWeaponDefinition::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+void UWeaponDefinition::GetClientAssetPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	const FSoftObjectPath Paths[] = {
+		CrosshairsCenter.ToSoftObjectPath(),
+		CrosshairsLeft.ToSoftObjectPath(),
+		CrosshairsRight.ToSoftObjectPath(),
+		CrosshairsTop.ToSoftObjectPath(),
+		CrosshairsBottom.ToSoftObjectPath(),
+		EquipSound.ToSoftObjectPath(),
+		FireAnimation.ToSoftObjectPath(),
+		CasingClass.ToSoftObjectPath(),
+		ImpactParticles.ToSoftObjectPath(),
+		ImpactEffects.ToSoftObjectPath()
+	};
+	for (const FSoftObjectPath& Path : Paths)
+	{
+		if (!Path.IsNull())
+		{
+			OutPaths.Add(Path);
+		}
+	}
+}
@@ -3,7 +3,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Character/CharacterComponents/ShotLog.h"
 #include "Character/HUD/CharacterHUD.h"
+#include "Character/Weapon/AmmoInventory.h"
 #include "Character/Weapon/WeaponTypes.h"
 #include "Components/ActorComponent.h"
 #include "RPG/CharacterTypes/CombatState.h"
@@ -14,6 +16,36 @@
 class AWeapon;
 class AMainCharacter;
 
+// One shot as sent by the owner. Several can go out in the same batch
+USTRUCT()
+struct FShotRequest
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize HitTarget;
+
+	// Where the shooter saw the shot leave the weapon. Checked for plausibility before it is trusted
+	UPROPERTY()
+	FVector_NetQuantize MuzzleLocation;
+
+	// Server time of the world state the shooter saw when the shot was due, used to rewind hitscan targets
+	UPROPERTY()
+	float FireTime = 0.f;
+
+	// Identifies the owner's predicted shot so the weapon can acknowledge it
+	UPROPERTY()
+	uint16 Sequence = 0;
+
+	// Seeds the weapon's spread, so multi-pellet shots need no per-pellet data
+	UPROPERTY()
+	uint16 SpreadSeed = 0;
+
+	// Loadout slot of the weapon the shot was fired with. Shots for a slot no longer in hand are rejected
+	UPROPERTY()
+	uint8 Slot = 0;
+};
+
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class RPG_API UCombatComponent : public UActorComponent
 {
@@ -22,34 +54,51 @@ class RPG_API UCombatComponent : public UActorComponent
 public:
 	UCombatComponent();
 	friend class AMainCharacter;
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
-	                           FActorComponentTickFunction* ThisTickFunction) override;
+	friend class UMainCharacterMovementComponent;
+	// Ticked by the owning character's batched tick
+	void BatchedTick(float DeltaTime);
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
 	void EquipWeapon(AWeapon* WeaponToEquip);
+	void SwapToNextWeapon();
+	// Server. Drops the weapon in hand and destroys the holstered ones
+	void DiscardLoadout();
+	void DestroyHolsteredWeapons();
 	void Reload();
 	UFUNCTION(BlueprintCallable)
 	void FinishReloading();
 	UFUNCTION()
 	void FireButtonPressed(bool bPressed);
+	void PlayShotRecord(const FShotRecord& Record);
 
 protected:
 	virtual void BeginPlay() override;
+	// Owner side. The server learns of it through the aim flag in the owner's moves
 	void SetAiming(bool bIsAiming);
 
-	UFUNCTION(Server, Reliable)
-	void ServerSetAiming(bool bIsAiming);
-
 	UFUNCTION()
 	void OnRep_EquipedWeapon();
 
-	void Fire();
+	UFUNCTION(Server, Reliable)
+	void ServerSwapWeapon(int32 Slot);
 
+	void SwapToSlot(int32 Slot);
+	void ActivateWeapon(AWeapon* Weapon);
+	void HolsterWeapon(AWeapon* Weapon);
+	void PlayEquipSound();
+	void SpawnDefaultLoadout();
 
+	void Fire();
+
+	// All shots the owner fired since the last flush, in fire order
 	UFUNCTION(Server, Reliable)
-	void ServerFire(const FVector_NetQuantize& TraceHitTarget);
+	void ServerFireBatch(const TArray<FShotRequest>& Shots);
+
+	void ServerFire(const FShotRequest& Shot);
 
-	UFUNCTION(NetMulticast, Reliable)
-	void MulticastFire(const FVector_NetQuantize& TraceHitTarget);
+	bool ValidateServerFire(float FireTime) const;
+
+	// Montage and weapon fire effects for one confirmed shot
+	void LocalFire(const FVector& TraceHitTarget, bool bShotAiming, uint16 SpreadSeed);
 
 	UFUNCTION()
 	void TraceUnderCrosshair(FHitResult& TraceHitResult);
@@ -76,6 +125,31 @@ private:
 	UPROPERTY(ReplicatedUsing = OnRep_EquipedWeapon)
 	AWeapon* EquippedWeapon;
 
+	// Loadout
+
+	// Spawned once on the server when the character starts, first entry in hand
+	UPROPERTY(EditAnywhere, Category = "Loadout")
+	TArray<TSubclassOf<AWeapon>> DefaultLoadout;
+
+	UPROPERTY(EditAnywhere, Category = "Loadout")
+	int32 MaxLoadoutSlots = 3;
+
+	// Every carried weapon. Holstered ones stay spawned, hidden and dormant until swapped to
+	UPROPERTY(Replicated)
+	TArray<AWeapon*> Loadout;
+
+	UPROPERTY(Replicated)
+	int32 ActiveSlot = INDEX_NONE;
+
+	// Owner: when the pending swap was requested. Firing waits for the new weapon until it arrives
+	// or MaxSwapWaitTime has passed, e.g. because the server refused the swap
+	double SwapRequestTime = 0.0;
+
+	UPROPERTY(EditAnywhere, Category = "Loadout")
+	float MaxSwapWaitTime = 1.f;
+
+	bool IsSwapPending() const;
+
 	UPROPERTY(Replicated)
 	bool bAiming;
 
@@ -87,6 +161,13 @@ private:
 
 	bool bFireButtonPressed;
 
+	UPROPERTY(Replicated)
+	FShotLog ShotLog;
+
+	// Replicated shots older than this are skipped instead of replayed
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	float MaxShotPlaybackAge = 0.5f;
+
 
 	// HUD
 
@@ -115,23 +196,58 @@ private:
 
 	// Automatic fire
 
-	FTimerHandle FireTimer;
+	// Time left until the next shot may go out. Carries the sub-frame remainder between shots
+	// so the fire rate does not depend on frame time
+	float FireCooldown = 0.f;
+
+	bool bFireCooldownActive = false;
 
-	bool bCanFire = true;
+	// Owner: shots fired this frame that still have to be sent
+	TArray<FShotRequest> PendingShots;
 
-	void StartFireTimer();
-	void FireTimerFinished();
+	// Upper bound on shots fired in one frame and accepted from one batch
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	int32 MaxShotsPerFrame = 8;
+
+	// Server: client time of the last accepted shot, for cadence validation
+	float LastServerFireTime = -1.f;
+
+	// Server: claimed fire times are clamped to at most this far before the server's clock
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	float MaxFireRewindTime = 0.5f;
+
+	// Server: shots the owner may still fire, refilled by one per FireDelay of server time so the
+	// rate of fire holds no matter how the owner stamps or sends its shots
+	float ShotBudget = 0.f;
+	float LastShotBudgetTime = -1.f;
+
+	// Shots that can be banked, absorbs batches arriving bunched up by network jitter
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	float MaxShotBudget = 3.f;
+
+	bool ConsumeShotBudget(float ServerTime);
+
+	// Fraction of FireDelay a shot may arrive early before the server rejects it
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	float FireCadenceTolerance = 0.8f;
+
+	void UpdateFireScheduler(float DeltaTime);
+	void QueueShot(float FireTime);
+	void FlushShots();
+	float GetFireClock();
 
 	bool CanFire();
 
-	//Carried ammo for currently-equipped weapon
+	// Carried ammo for every weapon type, so the owner knows all pools without extra RPCs
 	UPROPERTY(ReplicatedUsing = OnRep_CarriedAmmo)
-	int32 CarriedAmmo;
+	FAmmoInventory CarriedAmmo;
 
 	UFUNCTION()
 	void OnRep_CarriedAmmo();
 
-	TMap<EWeaponType, int32> CarriedAmmoMap;
+	// Carried ammo for the equipped weapon's type
+	int32 GetCarriedAmmo() const;
+	void UpdateHUDCarriedAmmo();
 
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	int32 StartingARAmmo = 30;
@@ -139,6 +255,9 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	int32 StartingPistolAmmo = 0;
 
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	int32 StartingShotgunAmmo = 0;
+
 	void InitializeCarriedAmmo();
 
 	UPROPERTY(ReplicatedUsing = OnRep_CombatState)
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "RPG/CharacterTypes/HitRegion.h"
+#include "LagCompensationComponent.generated.h"
+
+class AMainCharacter;
+
+// Capsule running along the bone's X axis from the bone origin
+USTRUCT()
+struct FHitboxDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere)
+	FName BoneName;
+
+	UPROPERTY(EditAnywhere)
+	EHitRegion Region = EHitRegion::EHR_Torso;
+
+	// Negative for bones whose X axis points back towards their parent
+	UPROPERTY(EditAnywhere)
+	float Length = 20.f;
+
+	UPROPERTY(EditAnywhere)
+	float Radius = 8.f;
+};
+
+// Hitbox capsule axis in world space
+struct FHitboxSegment
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+};
+
+/**
+ * Server-side hitbox history. Records a fixed-size ring buffer of per-bone capsule hitboxes
+ * so shots can be tested against where the character was on the shooter's screen,
+ * without moving the real mesh or querying its physics asset.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class RPG_API ULagCompensationComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	ULagCompensationComponent();
+	friend class AMainCharacter;
+
+	void RecordSnapshot(float ServerTime);
+
+	// Segment test against the interpolated historical pose. OutHitTime is the fraction along Start-End.
+	bool IntersectRewound(float Time, const FVector& Start, const FVector& End, float& OutHitTime,
+	                      FVector& OutHitLocation, EHitRegion& OutRegion) const;
+
+	float GetDamageMultiplier(EHitRegion Region) const;
+
+	// Interpolated actor location at Time
+	bool GetRewoundLocation(float Time, FVector& OutLocation) const;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	UPROPERTY()
+	AMainCharacter* Character;
+
+	UPROPERTY(EditAnywhere, Category = "Lag Compensation")
+	TArray<FHitboxDefinition> Hitboxes;
+
+	// Number of server frames kept in the history
+	UPROPERTY(EditAnywhere, Category = "Lag Compensation")
+	int32 HistoryCapacity = 32;
+
+	// Segments further than this from the recorded actor location skip the per-bone test
+	UPROPERTY(EditAnywhere, Category = "Lag Compensation")
+	float BroadphaseRadius = 150.f;
+
+	UPROPERTY(EditAnywhere, Category = "Lag Compensation")
+	float HeadDamageMultiplier = 2.f;
+
+	UPROPERTY(EditAnywhere, Category = "Lag Compensation")
+	float TorsoDamageMultiplier = 1.f;
+
+	UPROPERTY(EditAnywhere, Category = "Lag Compensation")
+	float LimbDamageMultiplier = 0.75f;
+
+	// Ring buffer. Snapshot i owns Hitboxes.Num() segments starting at i * Hitboxes.Num()
+	TArray<float> SnapshotTimes;
+	TArray<FVector> SnapshotLocations;
+	TArray<FHitboxSegment> SnapshotSegments;
+	int32 Head = INDEX_NONE;
+	int32 NumSnapshots = 0;
+
+	TArray<int32> BoneIndices;
+
+	void ResolveBoneIndices();
+	bool FindSnapshotPair(float Time, int32& OutOlder, int32& OutNewer, float& OutAlpha) const;
+
+public:
+	FORCEINLINE bool HasHistory() const { return NumSnapshots > 0; }
+};
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "MainCharacterMovementComponent.generated.h"
+
+class UMainCharacterMovementComponent;
+
+// Saved move that also remembers whether the character was aiming
+class FSavedMove_MainCharacter : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	uint8 bSavedWantsToAim : 1;
+};
+
+class FNetworkPredictionData_Client_MainCharacter : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_MainCharacter(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/**
+ * Character movement with aiming as part of the predicted move. The aim flag travels in the
+ * compressed move flags, so the slower aiming walk speed is predicted, replayed and corrected
+ * like any other movement input instead of waiting on an RPC.
+ */
+UCLASS()
+class RPG_API UMainCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	virtual float GetMaxSpeed() const override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	// Owner side. The server picks it up from the next move
+	void SetWantsToAim(bool bAim);
+	FORCEINLINE bool WantsToAim() const { return bWantsToAim; }
+
+	UPROPERTY(EditAnywhere, Category = "Character Movement: Walking")
+	float MaxWalkSpeedAiming = 400.f;
+
+protected:
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+
+private:
+	uint8 bWantsToAim : 1;
+};
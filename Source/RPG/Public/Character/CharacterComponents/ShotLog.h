@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "ShotLog.generated.h"
+
+class UCombatComponent;
+
+// Compact record of one confirmed shot, replicated for cosmetic playback only
+USTRUCT()
+struct FShotRecord : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize HitTarget;
+
+	// Server time the shot was fired. Records older than the playback window are not replayed
+	UPROPERTY()
+	float ServerTime = 0.f;
+
+	UPROPERTY()
+	bool bAiming = false;
+
+	UPROPERTY()
+	uint16 SpreadSeed = 0;
+
+	void PostReplicatedAdd(const struct FShotLog& InArraySerializer);
+};
+
+/**
+ * Rolling log of the last few shots. Every shot added during a frame goes out in the same
+ * delta update, and a dropped packet only costs cosmetics since the state is resent.
+ */
+USTRUCT()
+struct FShotLog : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FShotRecord> Shots;
+
+	UPROPERTY(NotReplicated)
+	UCombatComponent* OwnerComponent = nullptr;
+
+	void AddShot(const FVector& HitTarget, float ServerTime, bool bAiming, uint16 SpreadSeed);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FShotRecord, FShotLog>(Shots, DeltaParms, *this);
+	}
+
+	static constexpr int32 MaxShots = 16;
+};
+
+template<>
+struct TStructOpsTypeTraits<FShotLog> : public TStructOpsTypeTraitsBase2<FShotLog>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
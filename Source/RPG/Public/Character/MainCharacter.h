@@ -7,7 +7,10 @@
 #include "InputAction.h"
 #include "EnhancedInputSubsystems.h"
 #include "Interfaces/InteractWithCrosshairsInterface.h"
+#include "MeshSocketCache.h"
+#include "RotationSnapshotBuffer.h"
 #include "RPG/CharacterTypes/CombatState.h"
+#include "RPG/CharacterTypes/InputButtons.h"
 #include "RPG/CharacterTypes/TurningInPlace.h"
 #include "MainCharacter.generated.h"
 
@@ -18,10 +21,11 @@ class RPG_API AMainCharacter : public ACharacter, public IInteractWithCrosshairs
 	GENERATED_BODY()
 
 public:
-	AMainCharacter();
-	virtual void Tick(float DeltaTime) override;
+	AMainCharacter(const FObjectInitializer& ObjectInitializer);
+	friend class UCharacterTickSubsystem;
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreRegisterAllComponents() override;
 	virtual void PostInitializeComponents() override;
 	void PlayFireMontage(bool bAiming);
 	void PlayReloadMontage();
@@ -33,36 +37,48 @@ public:
 	UFUNCTION(NetMulticast, Reliable)
 	void MulticastElim(const FVector& HitDirection);
 
+	// Server. Everything this character took during the frame, applied by the damage pipeline
+	void ApplyFrameDamage(float Damage, AController* InstigatorController, AActor* DamageCauser);
+
 	UPROPERTY(Replicated)
 	bool bDisableGameplay = false;
 
+	// Server. Counts a gameplay RPC (equip, swap, fire batch, reload) received from this character's
+	// owning client. Movement RPCs are not counted
+	void CountServerRPC();
+
+	// Set by the possessing controller, cleared when it lets go
+	void BindController(class ACharacterPlayerController* InController);
+
 	void Destroyed() override;
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// Called by the character tick subsystem once the batched aim update has run
+	void BatchedTick(float DeltaTime);
+	// Actor tick is off, so a Blueprint Event Tick is called from the batch instead
+	bool bBlueprintImplementsTick = false;
 	void Move(const FInputActionValue& Value);
 	virtual void Jump() override;
 	void Look(const FInputActionValue& Value);
 	void Equip();
+	void SwapWeaponButtonPressed();
 	void Crouched();
 	void ReloadButtonPressed();
 	void AimButtonPressed();
 	void AimButtonReleased();
 	void FireButtonPressed();
 	void FireButtonReleased();
-	void CalculateAO_Pitch();
-	void AimOffset(float DeltaTime);
-	void SimProxiesTurn();
-	void TurnInPlace(float DeltaTime);
+	// False when the button was already in that state
+	bool SetInputButton(EInputButton Button, bool bPressed);
 	void PlayHitReactMontage();
 
 	
+	// Engine damage events from outside the weapon code are routed into the damage pipeline
 	UFUNCTION()
 	void ReceiveDamage(AActor* DamagedActor,  float Damage, const UDamageType* DamageType, class AController* InstigatorController,  AActor* DamageCauser);
 	void UpdateHUDHealth();
-	// Poll for relevant classes and initialize HUD
-	void PollInit();
-	void RotateInPlace(float DeltaTime);
 	
 private:
 	UPROPERTY(VisibleAnywhere, Category = "Camera")
@@ -83,6 +99,9 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	class UCombatComponent* CombatComponent;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	class ULagCompensationComponent* LagCompensation;
+
 	UPROPERTY(EditAnywhere,  Category = "Combat")
 	UAnimMontage* FireWeaponMontage;
 
@@ -98,10 +117,17 @@ private:
 	UFUNCTION(Server, Reliable)
 	void ServerEquipButtonPressed();
 
+	// Buttons held by the owner. Aim reaches the server in the movement flags, shots in their own batches
+	EInputButton InputButtons = EInputButton::EIB_None;
+
+	// Server. Gameplay RPCs received from the owning client, counted over one second windows
+	int32 ServerRPCCount = 0;
+	float ServerRPCWindowStart = 0.f;
+	float ServerRPCRate = 0.f;
+	void UpdateServerRPCRate();
+
 	float AO_Yaw;
-	float InterpAO_Yaw;
 	float AO_Pitch;
-	FRotator StartingAimRotation;
 	ETurningInPlace TurningInPlace;
 
 	void HideCameraIfCharacterClose();
@@ -110,12 +136,16 @@ private:
 	float CameraThreshold = 200.f;
 
 	bool bRotateRootBone;
-	float TurnThreshold = 0.5f;
-	FRotator ProxyRotationLastFrame;
-	FRotator ProxyRotation;
-	float ProxyYaw;
-	float TimeSinceLastMovementReplication;
-	float CalculateSpeed();
+
+	// Remote characters. Rotation and aim as received, played back ProxyInterpDelay in the past
+	FRotationSnapshotBuffer ProxySnapshots;
+
+	UPROPERTY(EditAnywhere, Category = "Network")
+	float ProxyInterpDelay = 0.1f;
+
+	// Degrees per second of smoothed yaw above which a standing remote character turns in place
+	UPROPERTY(EditAnywhere, Category = "Network")
+	float ProxyTurnRate = 30.f;
 
 	//Player Health
 
@@ -139,8 +169,10 @@ private:
 
 	void ElimTimerFinished();
 
-
-	class ACharacterPlayerState* PlayerState;
+	// Weapon hand socket and bone, used on equip and every animation update
+	FMeshSocketCache MeshSockets;
+	int32 RightHandSocket;
+	int32 RightHandBone;
 
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Enhanced Input")
@@ -176,11 +208,17 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Enhanced Input")
 	class UInputAction* ReloadButtonPressedAction;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Enhanced Input")
+	class UInputAction* SwapWeaponAction;
+
 	void SetOverlappingWeapon(AWeapon* Weapon);
 	bool IsWeaponEquipped();
 	bool IsAiming();
 	FORCEINLINE float GetAO_Yaw() const { return AO_Yaw; }
 	FORCEINLINE float GetAO_Pitch() const { return AO_Pitch; }
+	// Gameplay RPCs per second from the owning client, see CountServerRPC
+	FORCEINLINE float GetServerRPCRate() const { return ServerRPCRate; }
+	FORCEINLINE float GetProxyInterpDelay() const { return ProxyInterpDelay; }
 	AWeapon* GetEquippedWeapon();
 	FORCEINLINE ETurningInPlace GetTurningInPlace() const { return TurningInPlace; }
 	FVector GetHitTarget() const;
@@ -191,5 +229,9 @@ public:
 	FORCEINLINE float GetMaxHealth() const { return MaxHealth; }
 	ECombatState GetCombatState() const;
 	FORCEINLINE UCombatComponent* GetCombatComponent() const { return CombatComponent; }
+	class UMainCharacterMovementComponent* GetMainCharacterMovement() const;
+	FORCEINLINE ULagCompensationComponent* GetLagCompensation() const { return LagCompensation; }
 	FORCEINLINE bool GetDisableGameplay() const { return bDisableGameplay; }
+	const class USkeletalMeshSocket* GetRightHandSocket();
+	bool GetRightHandBoneTransform(FTransform& OutTransform);
 };
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMesh;
+class USkeletalMeshComponent;
+class USkeletalMeshSocket;
+
+/**
+ * Socket and bone names resolved once against a skeletal mesh component, so hot paths work
+ * with indices instead of name lookups. Names are registered up front, usually in a
+ * constructor. The cache re-resolves itself the first time it is used after the component's
+ * mesh changes.
+ */
+class RPG_API FMeshSocketCache
+{
+public:
+	// Registers a socket or bone name, returns the handle for the accessors below
+	int32 Add(FName Name);
+
+	// Null when the mesh has no socket of that name (a bare bone still resolves a bone index)
+	const USkeletalMeshSocket* GetSocket(const USkeletalMeshComponent* Mesh, int32 Handle);
+
+	int32 GetBoneIndex(const USkeletalMeshComponent* Mesh, int32 Handle);
+
+	// World space transform of the socket or bone. False when the name isn't on the mesh
+	bool GetTransform(const USkeletalMeshComponent* Mesh, int32 Handle, FTransform& OutTransform);
+
+private:
+	struct FEntry
+	{
+		FName Name;
+		const USkeletalMeshSocket* Socket = nullptr;
+		int32 BoneIndex = INDEX_NONE;
+		// Socket offset from its bone, identity for a bare bone
+		FTransform LocalTransform;
+	};
+
+	TArray<FEntry> Entries;
+
+	TWeakObjectPtr<const USkeletalMesh> ResolvedMesh;
+
+	void Resolve(const USkeletalMeshComponent* Mesh);
+	const FEntry* Find(const USkeletalMeshComponent* Mesh, int32 Handle);
+};
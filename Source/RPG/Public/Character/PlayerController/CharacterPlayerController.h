@@ -21,18 +21,27 @@ public:
 	void SetHudCarriedAmmo(int32 Ammo);
 	void SetHudMatchCountdown(float CountdownTime);
 	void SetHudAnnouncementCountdown(float CountdownTime);
-	virtual void OnPossess(APawn* InPawn) override;
+	virtual void SetPawn(APawn* InPawn) override;
+	virtual void OnRep_PlayerState() override;
 	virtual void Tick(float DeltaTime) override;
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
 	
 	virtual float GetServerTime();
+	// Half the round trip measured by the last clock sync, 0 on the server
+	FORCEINLINE float GetSingleTripTime() const { return SingleTripTime; }
 	virtual void ReceivedPlayer() override; // Sync with server clock
 	void OnMatchStateSet(FName State);
 	void HandleCooldown();
+	// Called by the HUD once it has begun play
+	void NotifyHUDReady(class ACharacterHUD* HUD);
+	FORCEINLINE ACharacterHUD* GetCharacterHUD() const { return CharacterHUD; }
 protected:
 	virtual void BeginPlay() override;
 	void SetHudTime();
-	void PollInit();
+	// Caches pawn, player state and HUD and hands them out. Runs whenever one of them changes
+	void UpdatePlayerBindings();
+	// Local controller only. Fires once per pawn and overlay, when all of them are bound
+	void OnPlayerReady();
 	void HandleMatchHasStarted();
 
 	// Sync time
@@ -47,6 +56,8 @@ protected:
 
 	float ClientServerDelta = 0.f; // difference between client and server time
 
+	float SingleTripTime = 0.f;
+
 	UPROPERTY(EditAnywhere, Category="Time")
 	float TimeSyncFrequency = 5.f;
 
@@ -80,13 +91,16 @@ private:
 	void OnRep_MatchState();
 
 	UPROPERTY()
-	class UCharacterOverlay* CharacterOverlay;
+	class AMainCharacter* MainCharacter;
 
-	bool bInitializeCharacterOverlay = false;
+	UPROPERTY()
+	class ACharacterPlayerState* CharacterPlayerState;
 
-	float HudHealth;
-	float HudMaxHealth;
-	float HudScore;
-	
+	// What OnPlayerReady last ran for
+	UPROPERTY()
+	AMainCharacter* ReadyCharacter;
+
+	UPROPERTY()
+	class UCharacterOverlay* ReadyOverlay;
 };
 
@@ -6,6 +6,8 @@
 #include "GameFramework/PlayerState.h"
 #include "CharacterPlayerState.generated.h"
 
+class ACharacterPlayerController;
+
 /**
  * 
  */
@@ -18,10 +20,10 @@ public:
 	virtual void GetLifetimeReplicatedProps(TArray< FLifetimeProperty > & OutLifetimeProps) const override;
 	virtual void OnRep_Score() override;
 	void AddToScore(float ScoreAmount);
+	FORCEINLINE void SetCharacterController(ACharacterPlayerController* InController) { CharacterController = InController; }
 	
 private:
+	// Bound by the owning controller
 	UPROPERTY()
-	class AMainCharacter* Character;
-	UPROPERTY()
-	class ACharacterPlayerController* CharacterController;
+	ACharacterPlayerController* CharacterController;
 };
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Rotation and aim of a remote character at the moment it was received
+struct FRotationSnapshot
+{
+	float Time = 0.f;
+	float Yaw = 0.f;
+	float AimPitch = 0.f;
+};
+
+/**
+ * Fixed-size ring buffer of timestamped rotation snapshots for a remote character. Played
+ * back a little in the past, so there is nearly always a snapshot on each side of the
+ * playback time and yaw and aim pitch can be interpolated instead of stepping from update
+ * to update.
+ */
+class RPG_API FRotationSnapshotBuffer
+{
+public:
+	explicit FRotationSnapshotBuffer(int32 Capacity = 32);
+
+	// Snapshots have to come in time order, older ones are dropped
+	void Add(float Time, float Yaw, float AimPitch);
+
+	// Interpolated rotation at Time, held at the oldest or newest snapshot outside the buffer.
+	// False while the buffer is empty
+	bool Sample(float Time, float& OutYaw, float& OutAimPitch) const;
+
+	void Reset();
+	FORCEINLINE int32 Num() const { return Count; }
+	// Null while the buffer is empty
+	const FRotationSnapshot* GetNewest() const { return Count > 0 ? &GetByAge(0) : nullptr; }
+
+private:
+	TArray<FRotationSnapshot> Snapshots;
+	// Where the next snapshot goes
+	int32 Head = 0;
+	int32 Count = 0;
+
+	// 0 is the newest snapshot
+	const FRotationSnapshot& GetByAge(int32 Age) const;
+};
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RPG/CharacterTypes/SoundCategory.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AudioDispatchSubsystem.generated.h"
+
+class UAudioComponent;
+class USoundBase;
+
+USTRUCT()
+struct FAudioVoicePool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<UAudioComponent*> Free;
+
+	UPROPERTY()
+	TArray<UAudioComponent*> Playing;
+};
+
+// What the dispatcher did with the sounds of the last frame
+struct FAudioDispatchFrameStats
+{
+	int32 Requested = 0;
+	int32 Played = 0;
+	int32 Culled = 0;
+};
+
+/**
+ * Client-side one-shot sounds. Each sound category has a voice limit and its own pool of
+ * audio components that are reused once their sound finishes. Sounds the local listener
+ * is too far away to hear, or that would go over their category's limit, are dropped.
+ */
+UCLASS()
+class RPG_API UAudioDispatchSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// False when the sound was culled
+	bool PlaySound(USoundBase* Sound, const FVector& Location, ESoundCategory Category);
+
+	FORCEINLINE const FAudioDispatchFrameStats& GetLastFrameStats() const { return LastFrameStats; }
+
+	// Never created in a server build
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// Indexed by ESoundCategory
+	UPROPERTY()
+	TArray<FAudioVoicePool> Pools;
+
+	int32 MaxVoices[static_cast<uint8>(ESoundCategory::ESC_MAX)] = { 6, 8, 4 };
+
+	// Sounds with no attenuation are heard this far
+	float DefaultAudibleDistance = 4000.f;
+
+	FAudioDispatchFrameStats FrameStats;
+	FAudioDispatchFrameStats LastFrameStats;
+
+	bool IsAudible(USoundBase* Sound, const FVector& Location) const;
+	UAudioComponent* AcquireVoice(ESoundCategory Category);
+	void ReclaimFinishedVoices();
+};
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CasingSubsystem.generated.h"
+
+class ACasing;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Cosmetic shell casings without actors. Live casings are stored as structure-of-arrays and
+ * fly a ballistic arc that bounces on the floor found under the ejection point, and each
+ * casing class is drawn through a single instanced static mesh. Nothing runs on a
+ * dedicated server.
+ */
+UCLASS()
+class RPG_API UCasingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Mesh, speed and bounce settings are read from the casing class defaults
+	void EjectCasing(TSubclassOf<ACasing> CasingClass, const FTransform& EjectTransform, const FVector& InheritedVelocity);
+
+	FORCEINLINE int32 GetNumCasings() const { return Positions.Num(); }
+
+	// Never created in a server build
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// Casing types seen so far, indexed by TypeIndices, each with its own instanced mesh
+	UPROPERTY()
+	TArray<UClass*> CasingTypes;
+
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> Renderers;
+
+	// Owns the instanced meshes, spawned once on first use
+	UPROPERTY()
+	AActor* RendererActor;
+
+	// Live casings
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<FQuat> Rotations;
+	TArray<FVector> AngularVelocities;
+	TArray<float> FloorZ;
+	// Seconds left, the casing shrinks away over the last FadeTime
+	TArray<float> Lifetimes;
+	TArray<uint8> TypeIndices;
+	TArray<bool> Bounced;
+
+	// Per-type transforms written to the instanced meshes each tick
+	TArray<TArray<FTransform>> InstanceTransforms;
+	int32 NumRendered = 0;
+
+	// The oldest casing starts fading out when a new one would go past this
+	int32 MaxCasings = 256;
+
+	float FadeTime = 0.5f;
+
+	// Casings never travel further down than this looking for a floor
+	float MaxFloorDistance = 500.f;
+
+	// Shell sounds closer together than this are dropped
+	float MinSoundInterval = 0.05f;
+	double LastSoundTime = 0.0;
+
+	int32 FindOrAddType(TSubclassOf<ACasing> CasingClass);
+	void FadeOldestCasing();
+	void Integrate(float DeltaTime);
+	void UpdateRenderers();
+	void RemoveCasing(int32 Index);
+};
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "RPG/CharacterTypes/TurningInPlace.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CharacterTickSubsystem.generated.h"
+
+class AMainCharacter;
+class UCharacterTickSubsystem;
+
+// Runs the character batch in TG_PrePhysics, after character movement and before the meshes animate
+USTRUCT()
+struct FCharacterBatchTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UCharacterTickSubsystem* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FCharacterBatchTickFunction> : public TStructOpsTypeTraitsBase2<FCharacterBatchTickFunction>
+{
+	enum { WithCopy = false };
+};
+
+// Which aim update a character gets this frame
+enum class ECharacterAimMode : uint8
+{
+	// Gameplay disabled, turning stops
+	Disabled,
+	// Locally controlled with a weapon: aim offset and turn in place
+	Local,
+	// Locally controlled without a weapon, nothing to update
+	Unarmed,
+	// Everyone else, live on the server and played back from rotation snapshots on proxies
+	Remote
+};
+
+/**
+ * Ticks every character in one batched pass instead of per-actor ticks. The aim offset and
+ * turn-in-place state of all characters is kept as structure-of-arrays: inputs are gathered
+ * on the game thread, the math runs over the arrays (on worker threads for large batches),
+ * then the results are written back for the animation instances to read. Per-character
+ * work with side effects runs afterwards on the game thread.
+ */
+UCLASS()
+class RPG_API UCharacterTickSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	void Tick(float DeltaTime);
+
+	void RegisterCharacter(AMainCharacter* Character);
+	void UnregisterCharacter(AMainCharacter* Character);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	FCharacterBatchTickFunction BatchTickFunction;
+
+	UPROPERTY()
+	TArray<AMainCharacter*> Characters;
+
+	// Gathered every frame
+	TArray<ECharacterAimMode> AimModes;
+	TArray<float> Speeds;
+	TArray<bool> InAir;
+	TArray<float> AimYaws;
+	TArray<float> AimPitches;
+	TArray<bool> Armed;
+	// Remote characters: interpolated yaw and the turn rate threshold
+	TArray<float> ProxyYaws;
+	TArray<float> ProxyTurnRates;
+
+	// Kept across frames
+	TArray<float> AO_Yaws;
+	TArray<float> InterpAO_Yaws;
+	TArray<float> AO_Pitches;
+	TArray<float> StartingAimYaws;
+	TArray<ETurningInPlace> TurningInPlace;
+	TArray<bool> RotateRootBone;
+	// Remote characters: interpolated yaw of the previous frame
+	TArray<float> LastProxyYaws;
+
+	// Below this many characters the batch stays on the game thread
+	int32 MinParallelCharacters = 32;
+
+	void RemoveStaleCharacters();
+	void Gather();
+	void UpdateAim(int32 Index, float DeltaTime);
+	void TurnInPlace(int32 Index, float DeltaTime);
+	void ProxyTurnInPlace(int32 Index, float DeltaTime);
+	void Scatter();
+};
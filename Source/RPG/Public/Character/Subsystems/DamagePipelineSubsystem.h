@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DamagePipelineSubsystem.generated.h"
+
+// One hit waiting for the end-of-frame damage flush
+struct FDamageHit
+{
+	TWeakObjectPtr<AActor> Victim;
+	TWeakObjectPtr<AController> InstigatorController;
+	TWeakObjectPtr<AActor> DamageCauser;
+	float Damage = 0.f;
+};
+
+/**
+ * Server-only. Collects every hit of the frame and applies them once per victim after all
+ * actors and subsystems have ticked, so a character takes one health change per frame
+ * however many bullets or pellets landed.
+ */
+UCLASS()
+class RPG_API UDamagePipelineSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	void QueueDamage(AActor* Victim, float Damage, AController* InstigatorController, AActor* DamageCauser);
+
+	FORCEINLINE int32 GetHitsLastFrame() const { return HitsLastFrame; }
+	FORCEINLINE int32 GetDamageEventsLastFrame() const { return DamageEventsLastFrame; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	TArray<FDamageHit> PendingHits;
+
+	// Summed damage per victim. Credit goes to the hit that made the total lethal, or else the last hit
+	struct FVictimDamage
+	{
+		AActor* Victim = nullptr;
+		TWeakObjectPtr<AController> InstigatorController;
+		TWeakObjectPtr<AActor> DamageCauser;
+		float Damage = 0.f;
+		bool bLethal = false;
+	};
+
+	// Per-flush scratch, kept to avoid reallocating
+	TArray<FVictimDamage> VictimDamage;
+	TMap<AActor*, int32> VictimIndices;
+
+	int32 HitsLastFrame = 0;
+	int32 DamageEventsLastFrame = 0;
+
+	FDelegateHandle PostActorTickHandle;
+
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime);
+	void FlushDamage();
+};
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Character/Weapon/ImpactEffectTable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ImpactEffectsSubsystem.generated.h"
+
+class UParticleSystemComponent;
+
+USTRUCT()
+struct FImpactParticlePool
+{
+	GENERATED_BODY()
+
+	// Every component created for this template, free or playing
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> Components;
+
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> Free;
+};
+
+/**
+ * Client-side impact cosmetics. Impacts queued during a frame are merged when they land close
+ * together. Particles are culled by distance and view direction from the local view and
+ * played within a per-frame budget from per-template pools of reusable components; sounds go
+ * through the audio dispatcher. Nothing is played on a dedicated server.
+ */
+UCLASS()
+class RPG_API UImpactEffectsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void QueueImpact(const FImpactEffect& Effect, const FVector& Location, const FRotator& Rotation);
+
+	// Surface of a trace hit, SurfaceType_Default when the hit carries no physical material
+	static EPhysicalSurface GetSurfaceType(const FHitResult& Hit);
+
+	// Never created in a server build
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FPendingImpact
+	{
+		FImpactEffect Effect;
+		FVector Location;
+		FRotator Rotation;
+	};
+	TArray<FPendingImpact> PendingImpacts;
+
+	UPROPERTY()
+	TMap<UParticleSystem*, FImpactParticlePool> ParticlePools;
+
+	// Impacts of the same effect closer than this in one frame play once
+	float MergeDistance = 50.f;
+
+	float MaxParticleDistance = 6000.f;
+
+	// Extra degrees around the view cone before an impact counts as off-screen
+	float ViewConeMargin = 10.f;
+
+	int32 MaxParticlesPerFrame = 12;
+	int32 MaxPooledPerTemplate = 32;
+
+	void SpawnParticles(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation);
+
+	UFUNCTION()
+	void OnParticlesFinished(UParticleSystemComponent* Component);
+};
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LagCompensationSubsystem.generated.h"
+
+class AMainCharacter;
+class ULagCompensationComponent;
+
+// A hitscan shot waiting to be checked against the rewound hitboxes. Multi-pellet shots have one end per pellet
+struct FRewindShot
+{
+	TWeakObjectPtr<APawn> Shooter;
+	TWeakObjectPtr<AController> InstigatorController;
+	TWeakObjectPtr<AActor> DamageCauser;
+	FVector Start = FVector::ZeroVector;
+	TArray<FVector> Ends;
+	float HitTime = 0.f;
+	// Per end
+	float Damage = 0.f;
+};
+
+// Game thread snapshot of a queued shot's actors, plus the verdict of its validation
+struct FShotCheck
+{
+	const APawn* Shooter = nullptr;
+	const AActor* DamageCauser = nullptr;
+	const ULagCompensationComponent* ShooterHistory = nullptr;
+	FVector ShooterLocation = FVector::ZeroVector;
+	float EyeHeight = 0.f;
+	bool bValid = false;
+};
+
+// One segment of a validated shot, traced on a worker thread
+struct FRewindRay
+{
+	int32 ShotIndex = INDEX_NONE;
+	FVector End = FVector::ZeroVector;
+
+	// Results
+	AMainCharacter* Victim = nullptr;
+	float HitTime = 1.f;
+	FVector HitLocation = FVector::ZeroVector;
+	float DamageMultiplier = 1.f;
+};
+
+/**
+ * Server-only. Records hitbox history for every registered character once per frame and
+ * resolves all hitscan shots received during the frame in one batch: shots are validated
+ * and their rays traced on worker threads, then damage is committed in queue order.
+ */
+UCLASS()
+class RPG_API ULagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterComponent(ULagCompensationComponent* Component);
+	void UnregisterComponent(ULagCompensationComponent* Component);
+	void QueueShot(const FRewindShot& Shot);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	UPROPERTY()
+	TArray<ULagCompensationComponent*> Components;
+
+	TArray<FRewindShot> PendingShots;
+
+	// Per-tick scratch, kept to avoid reallocating
+	TArray<FShotCheck> ShotChecks;
+	TArray<FRewindRay> Rays;
+
+	// Shots claiming to be older than this are clamped to it
+	float MaxRewindTime = 0.5f;
+
+	// Below this many rays the traces stay on the game thread
+	int32 MinParallelRays = 16;
+
+	// Furthest a claimed muzzle may be from the shooter's rewound location
+	float MaxMuzzleOffset = 200.f;
+
+	void RecordSnapshots(float ServerTime);
+	void ResolveShots(float ServerTime);
+	void ValidateShot(int32 ShotIndex, float ServerTime);
+	void TraceRay(FRewindRay& Ray, float ServerTime, const FCollisionObjectQueryParams& WorldObjects) const;
+	void ApplyRayDamage();
+};
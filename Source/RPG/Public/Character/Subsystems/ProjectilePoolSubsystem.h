@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectilePoolSubsystem.generated.h"
+
+class AProjectile;
+
+USTRUCT()
+struct FProjectilePool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AProjectile*> Free;
+
+	int32 NumActive = 0;
+	int32 PeakActive = 0;
+	int32 Requests = 0;
+	int32 Hits = 0;
+};
+
+/**
+ * Server-side pools of replicated projectiles, one per projectile class. Projectiles are
+ * parked and relaunched instead of spawned and destroyed for every bullet.
+ */
+UCLASS()
+class RPG_API UProjectilePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	void Prewarm(TSubclassOf<AProjectile> ProjectileClass, int32 Count);
+	AProjectile* AcquireProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Location,
+	                               const FRotator& Rotation, AActor* Owner, APawn* Instigator);
+	void ReleaseProjectile(AProjectile* Projectile);
+
+	// Fraction of requests served from the pool instead of a new spawn
+	float GetHitRate(TSubclassOf<AProjectile> ProjectileClass) const;
+	int32 GetPeakActive(TSubclassOf<AProjectile> ProjectileClass) const;
+	void LogPoolStats() const;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	UPROPERTY()
+	TMap<UClass*, FProjectilePool> Pools;
+
+	AProjectile* SpawnPooledProjectile(TSubclassOf<AProjectile> ProjectileClass);
+};
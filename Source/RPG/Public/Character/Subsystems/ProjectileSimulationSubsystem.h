@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectileSimulationSubsystem.generated.h"
+
+class AProjectile;
+
+/**
+ * Actor-free ballistic simulation. Live bullets are stored as structure-of-arrays, integrated
+ * in one pass per tick and swept against the world in parallel. Only authoritative bullets
+ * deal damage; the rest exist for cosmetics.
+ */
+UCLASS()
+class RPG_API UProjectileSimulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Gravity, damage and impact effects are read from the projectile class defaults.
+	// CatchUpTime fast-forwards a projectile whose spawn is already in the past, e.g. a replicated spawn event.
+	// Spawns further in the past than MaxCatchUpTime are dropped
+	void SpawnProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Origin, const FVector& Direction, float Speed,
+	                     APawn* InstigatorPawn, AActor* DamageCauser, bool bAuthoritative, float CatchUpTime = 0.f);
+
+	FORCEINLINE int32 GetNumProjectiles() const { return Positions.Num(); }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// Projectile types seen so far, indexed by TypeIndices
+	UPROPERTY()
+	TArray<UClass*> ProjectileTypes;
+
+	// Live projectiles
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> GravityZ;
+	TArray<float> Damages;
+	TArray<float> Lifetimes;
+	TArray<float> CatchUpTimes;
+	TArray<uint8> TypeIndices;
+	TArray<bool> Authoritative;
+	TArray<TWeakObjectPtr<APawn>> Instigators;
+	TArray<TWeakObjectPtr<AActor>> DamageCausers;
+	TArray<int32> TracerIds;
+
+	// Per-tick scratch, kept to avoid reallocating
+	TArray<FVector> PreviousPositions;
+	TArray<const AActor*> IgnoredActors;
+	TArray<FHitResult> SweepHits;
+	TArray<bool> HitFlags;
+
+	// Below this many projectiles the sweeps stay on the game thread
+	int32 MinParallelSweeps = 32;
+
+	// Late spawn events are only fast-forwarded this far, anything older is not spawned at all
+	float MaxCatchUpTime = 0.5f;
+
+	int32 FindOrAddType(TSubclassOf<AProjectile> ProjectileClass);
+	void Integrate(float DeltaTime);
+	void Sweep();
+	void ResolveHits();
+	void RemoveProjectile(int32 Index);
+};
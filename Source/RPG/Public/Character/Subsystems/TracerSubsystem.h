@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TracerSubsystem.generated.h"
+
+class UInstancedStaticMeshComponent;
+class UMaterialInterface;
+class UStaticMesh;
+
+/**
+ * Client-side bullet tracers for every weapon type. A tracer is a streak travelling along a
+ * ballistic path (straight for hitscan shots), stored as structure-of-arrays, and all of them
+ * are drawn as stretched instances of one instanced static mesh. Nothing runs on a dedicated server.
+ */
+UCLASS(Config = Game)
+class RPG_API UTracerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Tracer for a shot whose end is known, e.g. a hitscan trace
+	void AddTracer(const FVector& Start, const FVector& End, float Speed);
+
+	// Tracer for a projectile still in flight, falling with GravityZ like the projectile does.
+	// Returns INDEX_NONE when no tracer was started
+	int32 StartTracer(const FVector& Start, const FVector& Direction, float Speed, float MaxDistance, float GravityZ = 0.f);
+
+	// The projectile landed: the streak runs out at the point along its path closest to Location
+	void EndTracer(int32 TracerId, const FVector& Location);
+
+	FORCEINLINE int32 GetNumTracers() const { return Origins.Num(); }
+
+	// Never created in a server build
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// Stretched along its Z axis to the length of the streak
+	UPROPERTY(Config)
+	TSoftObjectPtr<UStaticMesh> TracerMesh;
+
+	UPROPERTY(Config)
+	TSoftObjectPtr<UMaterialInterface> TracerMaterial;
+
+	UPROPERTY(Config)
+	float TracerLength = 600.f;
+
+	UPROPERTY(Config)
+	float TracerWidth = 2.f;
+
+	UPROPERTY()
+	UInstancedStaticMeshComponent* Renderer;
+
+	// Owns the instanced mesh, spawned once on first use
+	UPROPERTY()
+	AActor* RendererActor;
+
+	// Mesh size, used to scale instances to world units
+	FVector MeshSize = FVector(100.f);
+
+	// Live tracers
+	TArray<int32> TracerIds;
+	TArray<FVector> Origins;
+	TArray<FVector> Directions;
+	TArray<float> Speeds;
+	TArray<float> GravityZ;
+	// Time since the streak left its origin
+	TArray<float> Ages;
+	// Age at which the head stops, when the projectile landed or ran out of range
+	TArray<float> MaxAges;
+
+	int32 NextTracerId = 0;
+
+	TArray<FTransform> InstanceTransforms;
+
+	bool EnsureRenderer();
+	FVector GetPathLocation(int32 Index, float Age) const;
+	void UpdateRenderer();
+	void RemoveTracer(int32 Index);
+};
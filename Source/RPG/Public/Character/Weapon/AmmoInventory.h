@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Character/Weapon/WeaponTypes.h"
+#include "AmmoInventory.generated.h"
+
+/**
+ * Carried ammo for every weapon type, indexed directly by EWeaponType. Replicates as one
+ * packed block and only when a count actually changed.
+ */
+USTRUCT()
+struct FAmmoInventory
+{
+	GENERATED_BODY()
+
+	static constexpr int32 NumTypes = static_cast<int32>(EWeaponType::EWT_MAX);
+
+	FORCEINLINE int32 Get(EWeaponType Type) const { return IsValidType(Type) ? Counts[static_cast<int32>(Type)] : 0; }
+	void Set(EWeaponType Type, int32 Amount);
+	FORCEINLINE void Add(EWeaponType Type, int32 Delta) { Set(Type, Get(Type) + Delta); }
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+	bool operator==(const FAmmoInventory& Other) const;
+
+private:
+	int32 Counts[NumTypes] = {};
+
+	static FORCEINLINE bool IsValidType(EWeaponType Type) { return static_cast<int32>(Type) < NumTypes; }
+};
+
+template<>
+struct TStructOpsTypeTraits<FAmmoInventory> : public TStructOpsTypeTraitsBase2<FAmmoInventory>
+{
+	enum
+	{
+		// Counts is not a UPROPERTY, copies and comparisons have to go through the native operators
+		WithCopy = true,
+		WithIdenticalViaEquality = true,
+		WithNetSerializer = true,
+	};
+};
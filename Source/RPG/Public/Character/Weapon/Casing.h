@@ -6,6 +6,11 @@
 #include "GameFramework/Actor.h"
 #include "Casing.generated.h"
 
+/**
+ * Shell casing archetype. Never spawned: the casing subsystem reads the mesh, ejection and
+ * bounce settings from the class defaults and renders every live casing through one
+ * instanced mesh per casing class.
+ */
 UCLASS()
 class RPG_API ACasing : public AActor
 {
@@ -14,22 +19,34 @@ class RPG_API ACasing : public AActor
 public:
 	ACasing();
 
-protected:
-	virtual void BeginPlay() override;
-
-	UFUNCTION()
-	virtual void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
-
-
 private:
 	UPROPERTY(VisibleAnywhere)
 	UStaticMeshComponent* CasingMesh;
 
+	// Speed along the ejection socket's forward vector, in cm/s
+	UPROPERTY(EditAnywhere)
+	float EjectionSpeed = 250.f;
+
+	// Random cone around the ejection direction, in degrees
+	UPROPERTY(EditAnywhere)
+	float EjectionSpread = 15.f;
+
+	// Share of the vertical speed kept on each bounce
+	UPROPERTY(EditAnywhere)
+	float Restitution = 0.35f;
+
+	// Seconds a casing stays around before it starts fading out
 	UPROPERTY(EditAnywhere)
-	float ShellEjectionImpulse;
+	float Lifetime = 4.f;
 
 	UPROPERTY(EditAnywhere)
 	class USoundCue* ShellSound;
 
 public:
+	UStaticMesh* GetCasingMesh() const;
+	FORCEINLINE float GetEjectionSpeed() const { return EjectionSpeed; }
+	FORCEINLINE float GetEjectionSpread() const { return EjectionSpread; }
+	FORCEINLINE float GetRestitution() const { return Restitution; }
+	FORCEINLINE float GetLifetime() const { return Lifetime; }
+	FORCEINLINE USoundCue* GetShellSound() const { return ShellSound; }
 };
@@ -15,12 +15,27 @@ class RPG_API AHitScanWeapon : public AWeapon
 	GENERATED_BODY()
 
 public:
-	virtual void Fire(const FVector& HitTarget) override;
-	
-private:
+	virtual void PostLoad() override;
+	virtual void Fire(const FVector& HitTarget, uint16 SpreadSeed) override;
+
+	// Server only. Damage is resolved by the lag compensation subsystem against the pose at HitTime,
+	// once the shooter's MuzzleLocation has been validated
+	void SubmitRewindShot(const FVector& MuzzleLocation, const FVector& HitTarget, float HitTime, uint16 SpreadSeed);
+
+protected:
+	// Trace ends for one trigger pull. Must give the same result on every machine for the same seed
+	virtual void BuildTraceEnds(const FVector& Start, const FVector& HitTarget, uint16 SpreadSeed, TArray<FVector>& OutEnds) const;
+
+	// Damage per trace end
 	UPROPERTY(EditAnywhere)
 	float Damage = 20.f;
 
+private:
+	// Saved on hitscan Blueprints before definitions existed, moved into the definition in PostLoad
+	UPROPERTY(meta = (DeprecatedProperty))
+	class UParticleSystem* ImpactParticles_DEPRECATED;
+
+	// Speed of the cosmetic tracer streak, in cm/s
 	UPROPERTY(EditAnywhere)
-	class UParticleSystem* ImpactParticles;
+	float TracerSpeed = 30000.f;
 };
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/DataAsset.h"
+#include "ImpactEffectTable.generated.h"
+
+class UParticleSystem;
+class USoundCue;
+
+USTRUCT(BlueprintType)
+struct FImpactEffect
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere)
+	UParticleSystem* Particles = nullptr;
+
+	UPROPERTY(EditAnywhere)
+	USoundCue* Sound = nullptr;
+
+	bool IsSet() const { return Particles != nullptr || Sound != nullptr; }
+};
+
+/**
+ * Impact effect per physical surface. The map is authored in the editor and flattened on
+ * first use into a byte per surface type indexing a small array of distinct effects.
+ */
+UCLASS(BlueprintType)
+class RPG_API UImpactEffectTable : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Falls back to DefaultEffect for surfaces without an entry
+	const FImpactEffect& FindEffect(EPhysicalSurface SurfaceType) const;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	UPROPERTY(EditAnywhere, Category = "Impact")
+	FImpactEffect DefaultEffect;
+
+	UPROPERTY(EditAnywhere, Category = "Impact")
+	TMap<TEnumAsByte<EPhysicalSurface>, FImpactEffect> SurfaceEffects;
+
+	// Flattened lookup: 0 is DefaultEffect, N is Effects[N - 1]
+	mutable TArray<uint8> SurfaceToEffect;
+	mutable TArray<FImpactEffect> Effects;
+
+	void BuildLookup() const;
+};
@@ -3,9 +3,39 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
 #include "GameFramework/Actor.h"
 #include "Projectile.generated.h"
 
+// Replicated flight of a pooled projectile. Clients launch and land their copy from it
+USTRUCT()
+struct FProjectileFlightState
+{
+	GENERATED_BODY()
+
+	// Bumped on every launch so back-to-back reuses are not missed
+	UPROPERTY()
+	uint8 FlightId = 0;
+
+	UPROPERTY()
+	bool bInFlight = false;
+
+	// Set when the flight ended on a hit, expired flights land without an impact
+	UPROPERTY()
+	bool bHit = false;
+
+	// Launch location while in flight, impact location once landed
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	// Surface that was hit, picks the impact effect
+	UPROPERTY()
+	TEnumAsByte<EPhysicalSurface> SurfaceType = SurfaceType_Default;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+};
+
 UCLASS()
 class RPG_API AProjectile : public AActor
 {
@@ -13,8 +43,10 @@ class RPG_API AProjectile : public AActor
 
 public:
 	AProjectile();
+	friend class UProjectilePoolSubsystem;
 	virtual void Tick(float DeltaTime) override;
 	virtual void Destroyed() override;
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
 
 protected:
 	virtual void BeginPlay() override;
@@ -25,7 +57,7 @@ protected:
 	UPROPERTY(EditAnywhere)
 	float Damage = 20.f;
 
-	
+
 private:
 	UPROPERTY(EditAnywhere)
 	class UBoxComponent* CollisionBox;
@@ -33,14 +65,64 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	class UProjectileMovementComponent* ProjectileMovementComponent;
 
+	// Drawn by the tracer subsystem from launch until impact
 	UPROPERTY(EditAnywhere)
-	UParticleSystem* Tracer;
-	
-	UParticleSystemComponent* TracerComponent;
+	bool bDrawTracer = true;
+
+	int32 TracerId = INDEX_NONE;
+
+	void StartTracer(const FVector& Location, const FVector& Direction);
+	void EndTracer();
 
 	UPROPERTY(EditAnywhere)
 	UParticleSystem* ImpactParticles;
 
 	UPROPERTY(EditAnywhere)
 	class USoundCue* ImpactSound;
+
+	// Per-surface impacts. ImpactParticles and ImpactSound are used when this is unset
+	UPROPERTY(EditAnywhere)
+	class UImpactEffectTable* ImpactEffects;
+
+	// Surface of the last hit, recorded on every machine the projectile collides on
+	TEnumAsByte<EPhysicalSurface> ImpactSurface = SurfaceType_Default;
+
+	void PlayImpactEffects();
+
+	// Pooling
+
+	UPROPERTY(Replicated)
+	bool bPooled = false;
+
+	UPROPERTY(ReplicatedUsing = OnRep_FlightState)
+	FProjectileFlightState FlightState;
+
+	UFUNCTION()
+	void OnRep_FlightState();
+
+	uint8 AppliedFlightId = 0;
+	bool bFlying = false;
+
+	// Pooled or simulated projectiles that never hit anything are retired after this long
+	UPROPERTY(EditAnywhere, Category = "Pooling")
+	float MaxLifetime = 5.f;
+
+	FTimerHandle PooledLifetimeTimer;
+
+	void LaunchFromPool(const FVector& Location, const FVector& Direction);
+	// bHit is false when the flight ran out of lifetime, which plays no impact
+	void ReturnToPool(bool bHit);
+	void ExpireFlight();
+	void StartFlight(const FVector& Location, const FVector& Direction);
+	void Park();
+
+public:
+	// Queues impact cosmetics at an arbitrary location, usable on the class default object
+	void SpawnImpactEffects(const UObject* WorldContextObject, const FVector& Location, const FRotator& Rotation,
+	                        EPhysicalSurface SurfaceType = SurfaceType_Default) const;
+	float GetInitialSpeed() const;
+	float GetGravityScale() const;
+	FORCEINLINE float GetDamage() const { return Damage; }
+	FORCEINLINE float GetMaxLifetime() const { return MaxLifetime; }
+	FORCEINLINE bool IsPooled() const { return bPooled; }
 };
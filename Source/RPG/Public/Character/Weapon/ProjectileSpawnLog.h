@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "ProjectileSpawnLog.generated.h"
+
+class AProjectile;
+class AProjectileWeapon;
+
+// Everything a client needs to fly its own copy of a simulated projectile
+USTRUCT()
+struct FProjectileSpawnEvent : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize Origin;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+
+	UPROPERTY()
+	float Speed = 0.f;
+
+	UPROPERTY()
+	TSubclassOf<AProjectile> ProjectileClass;
+
+	// Server time of the spawn, clients fast-forward the projectile by however late the event arrives
+	UPROPERTY()
+	float ServerTime = 0.f;
+
+	void PostReplicatedAdd(const struct FProjectileSpawnLog& InArraySerializer);
+};
+
+/**
+ * Rolling log of the last projectiles a weapon spawned into the simulation. Replaces one
+ * replicated actor per bullet with a single small item in the weapon's delta update.
+ */
+USTRUCT()
+struct FProjectileSpawnLog : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FProjectileSpawnEvent> Events;
+
+	UPROPERTY(NotReplicated)
+	AProjectileWeapon* OwnerWeapon = nullptr;
+
+	void AddEvent(TSubclassOf<AProjectile> ProjectileClass, const FVector& Origin, const FVector& Direction, float Speed, float ServerTime);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FProjectileSpawnEvent, FProjectileSpawnLog>(Events, DeltaParms, *this);
+	}
+
+	static constexpr int32 MaxEvents = 16;
+};
+
+template<>
+struct TStructOpsTypeTraits<FProjectileSpawnLog> : public TStructOpsTypeTraitsBase2<FProjectileSpawnLog>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
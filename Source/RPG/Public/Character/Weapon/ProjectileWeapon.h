@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Character/Weapon/Weapon.h"
+#include "Character/Weapon/ProjectileSpawnLog.h"
 #include "ProjectileWeapon.generated.h"
 
 /**
@@ -14,9 +15,30 @@ class RPG_API AProjectileWeapon : public AWeapon
 {
 	GENERATED_BODY()
 	public:
-		virtual void Fire(const FVector& HitTarget) override;
+		AProjectileWeapon();
+		virtual void Fire(const FVector& HitTarget, uint16 SpreadSeed) override;
+		virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+		void PlaySpawnEvent(const FProjectileSpawnEvent& Event);
+
+protected:
+	virtual void BeginPlay() override;
 
 private:
 	UPROPERTY(EditAnywhere)
 	TSubclassOf<class AProjectile> ProjectileClass;
+
+	// Reuse projectiles from the world pool instead of spawning one actor per shot
+	UPROPERTY(EditAnywhere, Category = "Pooling")
+	bool bUseProjectilePool = true;
+
+	UPROPERTY(EditAnywhere, Category = "Pooling")
+	int32 PoolPrewarmCount = 16;
+
+	// Fire into the actor-free projectile simulation instead of spawning projectile actors.
+	// Clients get a compact spawn event per shot and fly their own copy, only the server's copy deals damage
+	UPROPERTY(EditAnywhere, Category = "Simulation")
+	bool bSimulateProjectiles = false;
+
+	UPROPERTY(Replicated)
+	FProjectileSpawnLog SpawnLog;
 };
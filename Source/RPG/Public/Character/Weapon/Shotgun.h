@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Character/Weapon/HitScanWeapon.h"
+#include "Shotgun.generated.h"
+
+/**
+ * Hitscan weapon firing several pellets per trigger pull. Pellet directions come from the
+ * shot's spread seed, and the pellets are rewound and damaged together on the server.
+ */
+UCLASS()
+class RPG_API AShotgun : public AHitScanWeapon
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void BuildTraceEnds(const FVector& Start, const FVector& HitTarget, uint16 SpreadSeed, TArray<FVector>& OutEnds) const override;
+
+private:
+	UPROPERTY(EditAnywhere, Category = "Shotgun")
+	int32 NumberOfPellets = 10;
+
+	// Half-angle of the pellet cone in degrees
+	UPROPERTY(EditAnywhere, Category = "Shotgun")
+	float SpreadAngle = 6.f;
+};
@@ -4,19 +4,36 @@
 
 #include "CoreMinimal.h"
 #include "WeaponTypes.h"
+#include "Character/MeshSocketCache.h"
 #include "GameFramework/Actor.h"
 #include "Weapon.generated.h"
 
+struct FStreamableHandle;
+
 UENUM(BlueprintType)
 enum class EweaponState : uint8
 {
 	EWS_Initial UMETA(DisplayName = "Initial State"),
 	EWS_Equipped UMETA(DisplayName = "Equipped"),
 	EWS_Dropped UMETA(DisplayName = "Dropped"),
+	EWS_Holstered UMETA(DisplayName = "Holstered"),
 
 	EWS_MAX UMETA(DisplayName = "DefaultMax"),
 };
 
+// Server's view of the magazine, tagged with the last owner shot it has processed
+USTRUCT()
+struct FWeaponAmmoState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Ammo = 0;
+
+	UPROPERTY()
+	uint16 LastProcessedShot = 0;
+};
+
 
 UCLASS()
 class RPG_API AWeapon : public AActor
@@ -26,42 +43,26 @@ class RPG_API AWeapon : public AActor
 public:
 	AWeapon();
 	virtual void Tick(float DeltaTime) override;
+	virtual void PreRegisterAllComponents() override;
+	virtual void PostLoad() override;
+	virtual void PostInitializeComponents() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual void OnRep_Owner() override;
 	void SetHudAmmo();
 	void ShowPickupWidget(bool bShowWidget);
-	virtual void Fire(const FVector& HitTarget);
+	// SpreadSeed is shared by every machine playing the shot, so seeded spread lands identically
+	virtual void Fire(const FVector& HitTarget, uint16 SpreadSeed);
 	void Dropped();
 	void AddAmmo(int32 AmmoToAdd);
 
+	// Owning client: reserve the sequence number for a locally predicted shot
+	uint16 PredictShot();
 
-	
-	// Textures for weapon crosshairs
-	
-	UPROPERTY(EditAnywhere, Category = "Crosshairs")
-	class UTexture2D* CrosshairsCenter;
-
-	UPROPERTY(EditAnywhere, Category = "Crosshairs")
-	class UTexture2D* CrosshairsLeft;
-
-	UPROPERTY(EditAnywhere, Category = "Crosshairs")
-	class UTexture2D* CrosshairsRight;
-
-	UPROPERTY(EditAnywhere, Category = "Crosshairs")
-	class UTexture2D* CrosshairsTop;
-
-	UPROPERTY(EditAnywhere, Category = "Crosshairs")
-	class UTexture2D* CrosshairsBottom;
+	// Server: the owner's shot with this sequence has been handled (fired or rejected)
+	void AcknowledgeShot(uint16 Sequence);
 
-	// Zoom FOV aiming
-
-	UPROPERTY(EditAnywhere)
-	float ZoomedFOV = 30.f;
-
-	UPROPERTY(EditAnywhere)
-	float ZoomInterpSpeed = 20.f;
-
-	// Automatic fire
+	// Automatic fire, overridden by the definition when one is set
 
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	float FireDelay = .15f;
@@ -69,12 +70,13 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	bool bAutomatic = true;
 
-	UPROPERTY(EditAnywhere)
-	USoundCue* EquipSound;
-
 protected:
 	virtual void BeginPlay() override;
 
+	// Definition built in PostLoad for Blueprints saved before definitions existed. Null when the
+	// weapon already uses a definition asset, which is shared and must not be written to
+	UWeaponDefinition* GetOrCreateLegacyDefinition();
+
 	UFUNCTION()
 	virtual void OnSphereOverlap(
 		UPrimitiveComponent* OverlappedComponent,
@@ -98,6 +100,12 @@ private:
 	UPROPERTY(VisibleAnywhere, Category = "Weapon Properties")
 	class USphereComponent* AreaSphere;
 
+	// Muzzle, ammo eject and left hand sockets, read on every shot and every animation update
+	mutable FMeshSocketCache SocketCache;
+	int32 MuzzleFlashSocket;
+	int32 AmmoEjectSocket;
+	int32 LeftHandSocket;
+
 	UPROPERTY(ReplicatedUsing = OnRep_WeaponState, VisibleAnywhere, Category = "Weapon Properties")
 	EweaponState WeaponState;
 
@@ -107,20 +115,65 @@ private:
 	UPROPERTY(VisibleAnywhere, Category = "Weapon Properties")
 	class UWidgetComponent* PickupWidget;
 
+	// Stats and soft cosmetics shared by every weapon of this kind
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
-	UAnimationAsset* FireAnimation;
+	class UWeaponDefinition* Definition;
 
-	UPROPERTY(EditAnywhere)
-	TSubclassOf<class ACasing> CasingClass;
+	// Keeps the streamed cosmetics resident while this weapon is around. Never set on a dedicated server
+	TSharedPtr<FStreamableHandle> CosmeticsHandle;
 
-	UPROPERTY(EditAnywhere, ReplicatedUsing = OnRep_Ammo)
-	int32 Ammo;
+	void ApplyDefinition();
+	void LoadCosmetics();
+
+	// Cosmetics saved on weapon Blueprints before definitions existed, moved into a definition in PostLoad
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	class UTexture2D* CrosshairsCenter_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	UTexture2D* CrosshairsLeft_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	UTexture2D* CrosshairsRight_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	UTexture2D* CrosshairsTop_DEPRECATED;
 
+	UPROPERTY(meta = (DeprecatedProperty))
+	UTexture2D* CrosshairsBottom_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	class USoundCue* EquipSound_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	UAnimationAsset* FireAnimation_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty))
+	TSubclassOf<class ACasing> CasingClass_DEPRECATED;
+
+	// Authoritative on the server, predicted on the owning client
 	UPROPERTY(EditAnywhere)
+	int32 Ammo;
+
+	// Stats below are overridden by the definition when one is set
+
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	int32 MagCapacity;
 
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
+	float ZoomedFOV = 30.f;
+
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
+	float ZoomInterpSpeed = 20.f;
+
+	UPROPERTY(ReplicatedUsing = OnRep_AmmoState)
+	FWeaponAmmoState AmmoState;
+
 	UFUNCTION()
-	void OnRep_Ammo();
+	void OnRep_AmmoState();
+
+	// Last shot sequence issued by the owning client
+	uint16 ShotSequence = 0;
 
 	void SpendRound();
 
@@ -129,17 +182,23 @@ private:
 	UPROPERTY()
 	class ACharacterPlayerController* OwnerController;
 
-	UPROPERTY(EditAnywhere)
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	EWeaponType WeaponType;
 
 public:
 	void SetWeaponState(EweaponState State);
 	FORCEINLINE USphereComponent* GetAreaSphere() const { return AreaSphere; }
 	FORCEINLINE USkeletalMeshComponent* GetWeaponMesh() const { return WeaponMesh; }
+	FVector GetMuzzleLocation() const;
+	bool GetMuzzleTransform(FTransform& OutTransform) const;
+	bool GetLeftHandSocketTransform(FTransform& OutTransform) const;
 	FORCEINLINE float GetZoomedFOV() const { return ZoomedFOV; }
 	FORCEINLINE float GetZoomInterpSpeed() const { return ZoomInterpSpeed; }
 	bool IsEmpty();
 	FORCEINLINE EWeaponType GetWeaponType() const {return WeaponType; }
 	FORCEINLINE int32 GetAmmo() const {return Ammo; }
 	FORCEINLINE int32 GetMagCapacity() const {return MagCapacity; }
+	FORCEINLINE UWeaponDefinition* GetDefinition() const { return Definition; }
+	// Null until the cosmetics have streamed in, and always on a dedicated server
+	class USoundCue* GetEquipSound() const;
 };
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "WeaponTypes.h"
+#include "WeaponDefinition.generated.h"
+
+class ACasing;
+class UImpactEffectTable;
+class UParticleSystem;
+class USoundCue;
+class UTexture2D;
+
+/**
+ * Stats and cosmetics shared by every instance of a weapon. Stats are loaded with the weapon,
+ * cosmetics are soft references in the "Client" bundle, streamed in by clients when the weapon
+ * first becomes relevant and never loaded on a dedicated server.
+ */
+UCLASS(BlueprintType)
+class RPG_API UWeaponDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	static const FPrimaryAssetType PrimaryAssetType;
+	static const FName ClientBundle;
+
+	// Soft paths of the Client bundle, for definitions the asset manager doesn't know about
+	void GetClientAssetPaths(TArray<FSoftObjectPath>& OutPaths) const;
+
+	// Stats
+
+	UPROPERTY(EditDefaultsOnly, Category = "Stats")
+	EWeaponType WeaponType;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Stats")
+	int32 MagCapacity = 30;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Stats")
+	float FireDelay = .15f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Stats")
+	bool bAutomatic = true;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Stats")
+	float ZoomedFOV = 30.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Stats")
+	float ZoomInterpSpeed = 20.f;
+
+	// Cosmetics
+
+	UPROPERTY(EditDefaultsOnly, Category = "Crosshairs", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UTexture2D> CrosshairsCenter;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Crosshairs", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UTexture2D> CrosshairsLeft;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Crosshairs", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UTexture2D> CrosshairsRight;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Crosshairs", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UTexture2D> CrosshairsTop;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Crosshairs", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UTexture2D> CrosshairsBottom;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Cosmetics", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<USoundCue> EquipSound;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Cosmetics", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UAnimationAsset> FireAnimation;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Cosmetics", meta = (AssetBundles = "Client"))
+	TSoftClassPtr<ACasing> CasingClass;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Cosmetics", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UParticleSystem> ImpactParticles;
+
+	// Per-surface hitscan impacts, ImpactParticles is used when this is unset
+	UPROPERTY(EditDefaultsOnly, Category = "Cosmetics", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UImpactEffectTable> ImpactEffects;
+};
@@ -5,4 +5,10 @@
 #include "CoreMinimal.h"
 
 #define ECC_SkeletalMesh  ECollisionChannel::ECC_GameTraceChannel1
+// Crosshair and weapon traces. Characters answer it with their skeletal mesh, server hits are resolved against hitboxes
+#define ECC_WeaponTrace  ECollisionChannel::ECC_GameTraceChannel2
 
+DECLARE_LOG_CATEGORY_EXTERN(LogRPG, Log, All);
+
+// "stat RPG" shows the gameplay counters
+DECLARE_STATS_GROUP(TEXT("RPG"), STATGROUP_RPG, STATCAT_Advanced);